@@ -50,8 +50,12 @@
 #if defined(__ICCARM__) || defined(__CC_ARM) || defined(__GNUC__)
   #include <stdint.h>
   extern uint32_t SystemCoreClock;
+  void lowPower_SuppressTicksAndSleep(uint32_t u32ExpectedIdleTime);
+  #include "trace.h"
 #endif
 #define configUSE_PREEMPTION                     1
+#define configUSE_TICKLESS_IDLE                  2
+#define configEXPECTED_IDLE_TIME_BEFORE_SLEEP    3
 #define configSUPPORT_STATIC_ALLOCATION          1
 #define configSUPPORT_DYNAMIC_ALLOCATION         1
 #define configUSE_IDLE_HOOK                      0
@@ -60,11 +64,12 @@
 #define configTICK_RATE_HZ                       ((TickType_t)1000)
 #define configMAX_PRIORITIES                     ( 7 )
 #define configMINIMAL_STACK_SIZE                 ((uint16_t)128)
-#define configTOTAL_HEAP_SIZE                    ((size_t)7000)
+#define configTOTAL_HEAP_SIZE                    ((size_t)1024)
 #define configMAX_TASK_NAME_LEN                  ( 16 )
 #define configUSE_16_BIT_TICKS                   0
 #define configUSE_MUTEXES                        1
 #define configQUEUE_REGISTRY_SIZE                8
+#define configUSE_TRACE_FACILITY                 1
 
 /* Co-routine definitions. */
 #define configUSE_CO_ROUTINES                    0
@@ -105,6 +110,17 @@ standard names. */
 
 /* USER CODE BEGIN Defines */
 /* Section where parameter definitions can be added (for instance, to override default ones in FreeRTOS.h) */
+/* Tickless idle on STOP mode, see lowPower.c */
+#define portSUPPRESS_TICKS_AND_SLEEP( xExpectedIdleTime ) lowPower_SuppressTicksAndSleep( xExpectedIdleTime )
+
+/* Kernel trace recorder, see trace.c */
+#if (1==TRACE_ACTIVE)
+#define traceTASK_CREATE( pxNewTCB )     trace_TaskCreated( ( pxNewTCB )->uxTCBNumber, ( pxNewTCB )->pcTaskName )
+#define traceTASK_SWITCHED_IN()          trace_Record( TRACE_EVT_TASK_IN, ( uint8_t ) pxCurrentTCB->uxTCBNumber, 0 )
+#define traceQUEUE_SEND_FROM_ISR( pxQueue ) trace_Record( TRACE_EVT_QUEUE_ISR, 0, ( uint16_t ) ( uintptr_t ) ( pxQueue ) )
+#define traceTASK_NOTIFY_FROM_ISR()      trace_Record( TRACE_EVT_NOTIFY_ISR, ( uint8_t ) pxTCB->uxTCBNumber, 0 )
+#define traceTASK_NOTIFY_GIVE_FROM_ISR() trace_Record( TRACE_EVT_NOTIFY_ISR, ( uint8_t ) pxTCB->uxTCBNumber, 0 )
+#endif
 /* USER CODE END Defines */
 
 #endif /* FREERTOS_CONFIG_H */
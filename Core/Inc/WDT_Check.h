@@ -8,12 +8,15 @@
 
 
 #include "cmsis_os.h"
+#include "event_groups.h"
 #include "stdio.h"
 #include "stdbool.h"
 #include "main.h"
 
 
-#define DEBUG_WDT_CHECK_ACTIVE  0  //0:Disable WDT,  1:Enable WDT
+#ifndef DEBUG_WDT_CHECK_ACTIVE
+  #define DEBUG_WDT_CHECK_ACTIVE  0  //0:Disable WDT,  1:Enable WDT
+#endif
 #define WDT_CHECK_DEBUG         1  //0:Disable WDT,  1:Enable WDT
 #define WDT_CHECK_PROMPT    "WDT"
 
@@ -32,42 +35,26 @@
 #define WDT_CHECK_BLINK_TIMES_OK                  10
 #define WDT_CHECK_BLINK_TIMES_ERROR                1
 
-#define WDT_CHECK_ACTIVE_TASK                      7
-#define WDT_CHECK_COUNTER                          2
-#define WDT_REQUEST_COUNTER                        8
-#define WDT_MAX_COUNTER                            WDT_REQUEST_COUNTER + WDT_CHECK_COUNTER
+#define WDT_CHECK_REFRESH_PERIOD                 500   // ms between IWDG refreshes
+#define WDT_CHECK_MAX_TASKS                       24   // usable event group bits (32 bit ticks)
+#define WDT_CHECK_INVALID_ID                    0xFF
+#define WDT_CHECK_HEALTH_PERIOD                 4000   // ms between two health rounds
+#define WDT_CHECK_HEALTH_DEADLINE               1500   // ms a task has to answer a round
+#define WDT_CHECK_TASK_STACK_SIZE                250   // words
 
-#define WDT_CHECK_TASK_GPS_CODE                   0
-#define WDT_CHECK_TASK_SHELL_CODE                 1
-#define WDT_CHECK_TASK_CHECK_POS_CODE             2
 
-#define WDT_CHECK_TASK_GPS_VALUE                 0x1
-#define WDT_CHECK_TASK_SHELL_VALUE               0x2
-#define WDT_CHECK_TASK_CHECK_POS_VALUE           0x4
-
-
-#define WDT_CHECK_WATCHED_TASKS  WDT_CHECK_TASK_GPS_VALUE + \
-                                 WDT_CHECK_TASK_SHELL_VALUE + \
-                                 WDT_CHECK_TASK_CHECK_POS_VALUE
-
-typedef union
-{
-  uint8_t Register;
-  struct
-  {
-    char t0  :1;
-    char t1  :1;
-    char t2  :1;
-  } Task;
-} sWDTCheck_HealthTask;
+typedef void (*pfWDTCheck_HealthRequest)(void);
 
 typedef struct
 {
-  bool bCheckProcess;
-  bool bLaunchProcess;
-  uint16_t u16CounterProcess;
-  uint8_t  u8TaskToCheck;
-  sWDTCheck_HealthTask sTask;
+  EventGroupHandle_t xEvents;          // one bit per watched task
+  EventBits_t uxRegistered;            // bits of the registered tasks
+  uint8_t u8TaskCount;
+  pfWDTCheck_HealthRequest pfRequest[WDT_CHECK_MAX_TASKS];
+  TickType_t xLastRound;
+  uint32_t u32Rounds;
+  uint32_t u32LastRoundTicks;          // time until every task answered the last round
+  EventBits_t uxLastAnswered;          // bits of the last round
 } sWDTCheck_Health;
 
 
@@ -77,14 +64,15 @@ typedef struct
   uint8_t u8TimesBeforeReturn;
   uint16_t u16PeriodCurrent;
   uint16_t u16PeriodTemp;
-  sWDTCheck_Health sHealth;
+  bool bStopInhibit;           // a fast blink holds off STOP mode
 }WDTCheck;
 
 
 void WDTCheck_InitFW(void);
 void WDTCheck_Period(bool bIsPermanent, uint16_t u16Period, uint8_t u8Times);
-void WDTCheck_HealthRequest(char code);
-void WDTCheck_HealthResponse(char code);
+void WDTCheck_LedPeriodElapsed(void);
+uint8_t WDTCheck_RegisterTask(pfWDTCheck_HealthRequest pfRequest);
+void WDTCheck_HealthResponse(uint8_t u8TaskId);
 void WDTCheck_RestartCounter(void);
 void WDTCheck_RestartProcess(bool bIsFotActive);
 
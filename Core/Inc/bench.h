@@ -0,0 +1,55 @@
+/*******************************************************************************
+* Filename: bench.h
+* Developer: Jorge Yesid Rios Ortiz
+*******************************************************************************/
+
+#ifndef __BENCH_H
+#define __BENCH_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+#include "stdint.h"
+#include "stdbool.h"
+
+
+#define BENCH_PROMPT        "BENCH"
+#define BENCH_MAX_ITEMS     8
+#define BENCH_SAMPLES       15     // odd, the median is the middle sample
+#define BENCH_INVALID_ID    0xFF
+
+
+typedef void (*pfBench)(void);
+
+
+typedef struct
+{
+  const char *pName;
+  pfBench pfRun;          // timed, one call per sample
+  pfBench pfSetup;        // optional, untimed, before the first sample
+  pfBench pfTeardown;     // optional, untimed, after the last sample
+} sBenchItem;
+
+
+typedef struct
+{
+  uint32_t u32Min;
+  uint32_t u32Median;
+  uint32_t u32Max;
+} sBenchResult;
+
+
+void bench_Init(void);
+uint8_t bench_Register(const char *pName, pfBench pfRun, pfBench pfSetup, pfBench pfTeardown);
+uint32_t bench_Cycles(pfBench pfRun);
+void bench_Run(uint8_t u8Id, sBenchResult *pResult);
+void bench_Print(void);
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __BENCH_H */
@@ -18,6 +18,10 @@ extern "C" {
 #define CHECK_POS_DISTANCE             100
 #define CHECK_POS_EARTH_RAD_DEFAULT   6378.1
 
+// checkPos_Task wake reasons, task notification bits
+#define CHECK_POS_NOTIFY_TIMER        0x01   // distance check period
+#define CHECK_POS_NOTIFY_HEALTH       0x02   // watchdog health request
+
 
 typedef union
 {
@@ -31,19 +35,12 @@ typedef union
 } sCheckPosDataValidation;
 
 
-typedef struct
-{
-  bool bTimer;
-  bool bHealthRequest;
-} sCheckPosWakeupReason;
-
 typedef struct
 {
   double dLatitude;
   double dLongitude;
   double dDistance;
   double dEarthRad;
-  sCheckPosWakeupReason sWakeupReason;
   sCheckPosDataValidation sDoCheck;
 } sCheckPosApp;
 
@@ -58,6 +55,7 @@ bool   checkPos_SetLongitude(double dLon);
 double checkPos_GetLongitude(void);
 bool   checkPos_SetEarthRadius(double dLat);
 double checkPos_GetEarthRadius(void);
+double checkPos_Haversine(double dLatA, double dLonA, double dLatB, double dLonB, double dEarthRad);
 
 void checkPos_HealthRequest(void);
 
@@ -15,7 +15,11 @@ extern "C" {
 #include "stdlib.h"
 
 
+#define GPS_PROMPT                "GPS"
+
 #define GPS_RMC_NMEA_FRAME_FOUND  0x00
+#define GPS_GSV_NMEA_FRAME_FOUND  0x01
+#define GPS_REDUNDANT_NMEA_FRAME  0xFE    // one constellation copy of the combined GN solution
 #define GPS_UNKNOWN_NMEA_FRAME    0xFF
 
 
@@ -24,7 +28,35 @@ extern "C" {
 #define GPS_FRAME_TOKEN     ','
 #define GPS_FRAME_END       '*'
 
-#define GPS_TIMER_1_SEG   1099
+#define GPS_TASK_STACK_SIZE    200    // words
+
+// gps_Task wake reasons, task notification bits
+#define GPS_NOTIFY_RX_LINE     0x01   // '\n' received or Rx queue full
+#define GPS_NOTIFY_HEALTH      0x02   // watchdog health request
+#define GPS_NOTIFY_PPS         0x04   // PPS found or lost
+#define GPS_DECODE_BUDGET_US   5000   // one sentence, well below the 70ms it takes to arrive
+
+#define GPS_EPOCH_UNIX_TO_GPS    315964800   // 1980-01-06, start of the GPS time scale, in Unix seconds
+#define GPS_LEAP_SECONDS         18          // GPS time ahead of UTC since 2017-01-01
+#define GPS_SEC_PER_DAY          86400
+#define GPS_DAYS_2100_03_01      47541       // Unix day after the 29th of February 2100 that does not exist
+#define GPS_TIME_WINDOW_S        2           // a fix may run ahead of the RTOS tick this far (+3%)
+#define GPS_TIME_WINDOW_REJECTS  3           // consecutive fixes out of the window that move the time
+
+#define GPS_GNSS_HOLD_MS         3000        // a GN fix this recent mutes the GP/GL/GA/BD RMC
+#define GPS_GSV_SATS_PER_MSG     4
+
+
+typedef enum
+{
+  GPS_TALKER_GPS = 0,                     // GP
+  GPS_TALKER_GLONASS,                     // GL
+  GPS_TALKER_GALILEO,                     // GA
+  GPS_TALKER_BEIDOU,                      // BD or GB
+  GPS_CONSTELLATIONS,
+  GPS_TALKER_GNSS = GPS_CONSTELLATIONS,   // GN, solution of all the constellations
+  GPS_TALKER_UNKNOWN
+} eGpsTalker;
 
 
 typedef struct
@@ -97,9 +129,29 @@ typedef struct
 } sGpsDateTime;
 
 
+typedef struct
+{
+  uint8_t  u8InView;    // satellites announced by the GSV group
+  uint8_t  u8Tracked;   // with a SNR
+  uint8_t  u8SnrMax;    // dB-Hz
+  uint8_t  u8SnrAvg;    // of the tracked ones
+} sGpsConstellation;
+
+
+typedef struct
+{
+  uint8_t  u8NextMsg;   // next GSV message of the group, 0 when no group is open
+  uint8_t  u8InView;
+  uint8_t  u8Tracked;
+  uint8_t  u8SnrMax;
+  uint16_t u16SnrSum;
+} sGpsGsvGroup;
+
+
 typedef struct
 {
   int8_t  cStatus;
+  sGpsConstellation sConstellation[GPS_CONSTELLATIONS];
 } sGpsSateliteInfo;
 
 
@@ -122,8 +174,12 @@ typedef struct
 typedef struct
 {
   volatile bool             bValidFrame;
-  volatile bool             bHealthRequest;
   volatile uint32_t         u32ValidDataAge;
+  uint32_t                  u32FixTicks;      // time of the fix on the ppsClock timebase
+  uint32_t                  u32FixEpoch;      // Unix seconds of the last fix, 0 before the first one
+  uint32_t                  u32FixTick;       // RTOS tick of the last fix, anchor of gps_GetTimeMs
+  uint8_t                   u8TimeRejects;    // consecutive fixes out of the time window
+  uint8_t                   u8FixTalker;      // eGpsTalker of the last fix
   volatile sGpsPosition     sPos;
   sGpsDateTime              sDateTime;
   volatile sGpsSateliteInfo sSatInfo;
@@ -139,6 +195,9 @@ typedef struct
   volatile uint8_t  u8Month;
   volatile uint8_t  u8Day;
   volatile uint16_t u16Year;
+  volatile uint32_t u32Epoch;       // set by gps_ValidationNMEAData
+  volatile uint8_t  u8Talker;       // eGpsTalker of the RMC, set by gps_ExtractDataRMC
+  volatile sGpsGsvGroup sGsv[GPS_CONSTELLATIONS];
   volatile sGpsCoordinate sLatitude;
   volatile sGpsCoordinate sLongitude;
 } sGpsDataFromGps;
@@ -164,12 +223,34 @@ double gps_GetLongitudeDegreeDecimals(void);
 
 bool gps_IsValidFrame(void);
 uint32_t gps_GetValidDataAge(void);
+uint32_t gps_GetFixTicks(void);
+uint32_t gps_GetFixEpoch(void);
+void gps_ResetFixHistory(void);
+uint64_t gps_GetTimeMs(void);
+
+uint32_t gps_DateTimeToEpoch(const sGpsDateTime *pDateTime);
+void gps_EpochToDateTime(uint32_t u32Epoch, sGpsDateTime *pDateTime);
+uint32_t gps_EpochToGpsSeconds(uint32_t u32Epoch);
+uint32_t gps_GpsSecondsToEpoch(uint32_t u32GpsSeconds);
 
 void gps_PPSReceived(void);
 void gps_NoPPSReceived(void);
 
 void gps_HealthRequest(void);
 
+eGpsTalker gps_GetTalker(uint8_t *pData);
+sGpsConstellation gps_GetConstellation(eGpsTalker eTalker);
+void gps_PrintSatellites(void);
+
+// Decoder stages, in the order gps_FrameDecoder runs them (used by nmeaBench)
+uint8_t gps_FrameOfInterest(uint8_t *pData);
+bool gps_VerifyChecksumNmea(unsigned char * pData);
+void gps_ExtractDataRMC(uint8_t *pframe);
+void gps_ExtractDataGSV(uint8_t *pframe);
+bool gps_ValidationNMEAData(void);
+void gps_UpdateGpsData(void);
+sGpsCoordinate gps_ExtractCoordinate(uint8_t *pData);
+
 
 #ifdef __cplusplus
 }
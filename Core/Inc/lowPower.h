@@ -0,0 +1,62 @@
+/*******************************************************************************
+* Filename: lowPower.h
+* Developer: Jorge Yesid Rios Ortiz
+*******************************************************************************/
+
+#ifndef __LOW_POWER_H
+#define __LOW_POWER_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+#include "stdint.h"
+#include "stdbool.h"
+
+
+#define LOW_POWER_PROMPT          "LOW POWER"
+#define LOW_POWER_MAX_IDLE_MS     10000   // longest STOP period, keeps WUTR below 16 bits
+#define LOW_POWER_CAL_TIME_MS       200   // RTC against TIM6 calibration window
+#define LOW_POWER_RTC_NOMINAL_US   1000   // one RTC subsecond tick with PREDIV_A 39 and LSI at 40kHz
+#define LOW_POWER_RSF_WAIT_LOOPS   4000   // RSF sets within 2 RTCCLK (67us at the slowest LSI), ~0.5ms at 48MHz
+#define LOW_POWER_PLL_WAIT_LOOPS   2000   // PLL lock within 200us, ~1.5ms on the 8MHz HSI
+#define LOW_POWER_MAX_TIMERS          2   // peripheral timers that stop in STOP and follow the kernel time
+
+
+typedef uint32_t (*pfLowPowerMsToEvent)(void);   // ms until the timer has something to do
+typedef void (*pfLowPowerAdvance)(uint32_t u32Ms);
+
+
+typedef struct
+{
+  volatile uint8_t u8StopInhibit;   // >0: only SLEEP is allowed
+  bool bCalibrated;
+  uint32_t u32UsPerRtcTick;         // measured length of one RTC subsecond tick
+  uint32_t u32StopCount;
+  uint32_t u32StopMs;               // time spent in STOP
+  uint32_t u32WakeByTimer;
+  uint32_t u32RsfTimeouts;          // RTC read after STOP without a shadow register resync
+  uint32_t u32PllTimeouts;          // wakes left on HSI, PLL not locked in time
+  uint8_t u8Timers;
+  pfLowPowerMsToEvent pfMsToEvent[LOW_POWER_MAX_TIMERS];
+  pfLowPowerAdvance pfAdvance[LOW_POWER_MAX_TIMERS];
+} sLowPower;
+
+
+void lowPower_Init(void);
+void lowPower_Calibrate(void);
+void lowPower_StopInhibit(bool bInhibit);
+bool lowPower_RegisterTimer(pfLowPowerMsToEvent pfMsToEvent, pfLowPowerAdvance pfAdvance);
+uint32_t lowPower_IdleLimit(uint32_t u32ExpectedIdleTime);
+void lowPower_SuppressTicksAndSleep(uint32_t u32ExpectedIdleTime);
+void lowPower_RtcWakeup(void);
+uint32_t lowPower_TicksFromRtc(uint32_t u32RtcTicks, uint32_t u32UsPerRtcTick);
+void lowPower_Print(void);
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __LOW_POWER_H */
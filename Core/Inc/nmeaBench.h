@@ -0,0 +1,54 @@
+/*******************************************************************************
+* Filename: nmeaBench.h
+* Developer: Jorge Yesid Rios Ortiz
+*******************************************************************************/
+
+#ifndef __NMEA_BENCH_H
+#define __NMEA_BENCH_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+#include "stdint.h"
+#include "stdbool.h"
+
+
+#define NMEA_BENCH_PROMPT   "NMEA"
+#define NMEA_BENCH_PASSES   20     // times the corpus is replayed per run
+
+
+typedef enum
+{
+  NMEA_BENCH_STAGE_FILTER = 0,
+  NMEA_BENCH_STAGE_CHECKSUM,
+  NMEA_BENCH_STAGE_EXTRACT,
+  NMEA_BENCH_STAGE_VALIDATE,
+  NMEA_BENCH_STAGE_UPDATE,
+  NMEA_BENCH_STAGES
+} eNmeaBenchStage;
+
+
+typedef struct
+{
+  uint32_t au32Calls[NMEA_BENCH_STAGES];
+  uint32_t au32Us[NMEA_BENCH_STAGES];
+  uint32_t u32Sentences;
+  uint32_t u32Bytes;
+  uint32_t u32Skipped;       // dropped by talker and type before the checksum
+  uint32_t u32Rejected;      // bad checksum, truncated or noise
+  uint32_t u32Updates;       // sentences that reached the gps snapshot
+  uint32_t u32TotalUs;
+} sNmeaBenchResult;
+
+
+void nmeaBench_Run(uint8_t u8Passes, sNmeaBenchResult *pResult);
+void nmeaBench_Print(void);
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __NMEA_BENCH_H */
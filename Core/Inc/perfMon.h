@@ -0,0 +1,53 @@
+/*******************************************************************************
+* Filename: perfMon.h
+* Developer: Jorge Yesid Rios Ortiz
+*******************************************************************************/
+
+#ifndef __PERF_MON_H
+#define __PERF_MON_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+#include "stdint.h"
+#include "stdbool.h"
+
+
+#define PERF_MON_PROMPT        "PERF"
+#define PERF_MON_MAX_ITEMS     8
+#define PERF_MON_BUCKETS       16     // log2 buckets: <2us, <4us, ... , >=32ms
+#define PERF_MON_INVALID_ID    0xFF
+
+
+typedef struct
+{
+  const char *pName;
+  uint32_t u32BudgetUs;      // deadline of one execution
+  uint32_t u32StartUs;       // begin timestamp of the running execution
+  uint32_t u32Count;
+  uint32_t u32Misses;        // executions longer than the budget
+  uint32_t u32MaxUs;
+  uint32_t u32LastUs;
+  uint16_t au16Histogram[PERF_MON_BUCKETS];
+} sPerfMonItem;
+
+
+void perfMon_Init(void);
+void perfMon_TimerOverflow(void);
+uint32_t perfMon_GetUs(void);
+
+uint8_t perfMon_Register(const char *pName, uint32_t u32BudgetUs);
+void perfMon_Begin(uint8_t u8Id);
+uint32_t perfMon_End(uint8_t u8Id);
+
+void perfMon_Print(void);
+void perfMon_Reset(void);
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __PERF_MON_H */
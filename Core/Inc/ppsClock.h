@@ -0,0 +1,90 @@
+/*******************************************************************************
+* Filename: ppsClock.h
+* Developer: Jorge Yesid Rios Ortiz
+*******************************************************************************/
+
+#ifndef __PPS_CLOCK_H
+#define __PPS_CLOCK_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+#include "stdint.h"
+#include "stdbool.h"
+
+
+#define PPS_CLOCK_PROMPT          "PPS"
+#define PPS_CLOCK_NOMINAL_HZ      1000000   // TIM3 ticks per second with an ideal HSI
+#define PPS_CLOCK_MAX_PPM         20000     // intervals further from nominal are noise (HSI is +-1%)
+#define PPS_CLOCK_MAX_GAP         4         // missed edges bridged without losing the lock
+#define PPS_CLOCK_JITTER_TICKS    20        // accepted deviation of one interval once locked
+#define PPS_CLOCK_MAX_OUTLIERS    3         // consecutive outliers that drop the lock
+#define PPS_CLOCK_LOCK_COUNT      3         // good intervals before the clock is locked
+#define PPS_CLOCK_FILTER_SHIFT    3         // weight of a new interval, 1/8
+#define PPS_CLOCK_TIMEOUT_US      1100000   // no edge for this long: PPS lost
+#define PPS_CLOCK_SEC_PER_DAY     86400
+
+
+typedef struct
+{
+  uint32_t u32TicksPerSecQ8;  // TIM3 ticks between two PPS edges, 8 fractional bits
+  uint32_t u32LastEdge;       // timestamp of the last edge
+  uint32_t u32Intervals;      // accepted intervals
+  uint32_t u32Rejected;       // intervals out of the window
+  uint8_t  u8Good;            // consecutive accepted intervals
+  uint8_t  u8Outliers;        // consecutive outliers while locked
+  bool     bHasEdge;
+  bool     bLocked;
+} sPpsClockEstimator;
+
+
+typedef struct
+{
+  uint16_t u16Year;           // date of the last RMC anchor
+  uint8_t  u8Month;
+  uint8_t  u8Day;
+  uint32_t u32SecOfDay;
+  uint32_t u32Us;
+  bool     bValid;            // there is an RMC anchor
+  bool     bDisciplined;      // anchored on a PPS edge and the clock is locked
+} sPpsClockUtc;
+
+
+typedef struct
+{
+  volatile uint32_t u32Overflows;
+  volatile bool     bPresent;         // edges are arriving
+  volatile uint32_t u32LastEvent;     // last edge or timeout, for the PPS timeout
+  volatile uint32_t u32Edges;
+  sPpsClockEstimator sEstimator;
+  uint32_t u32AnchorTicks;            // timestamp of the second named by the last RMC
+  sPpsClockUtc sAnchor;
+} sPpsClock;
+
+
+void ppsClock_Init(void);
+bool ppsClock_TimerOverflow(void);
+bool ppsClock_Edge(void);
+uint32_t ppsClock_GetTicks(void);
+
+bool ppsClock_IsPresent(void);
+bool ppsClock_IsLocked(void);
+int32_t ppsClock_GetDriftPpb(void);
+
+uint32_t ppsClock_SetUtc(uint16_t u16Year, uint8_t u8Month, uint8_t u8Day, uint32_t u32SecOfDay);
+void ppsClock_TicksToUtc(uint32_t u32Ticks, sPpsClockUtc *pUtc);
+void ppsClock_GetUtc(sPpsClockUtc *pUtc);
+
+void ppsClock_EstimatorReset(sPpsClockEstimator *pEst);
+bool ppsClock_EstimatorUpdate(sPpsClockEstimator *pEst, uint32_t u32Edge);
+
+void ppsClock_Print(void);
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __PPS_CLOCK_H */
@@ -22,6 +22,12 @@ extern "C" {
 
 #define SHELL_RX_BUFFER_SIZE 150
 #define SHELL_TX_BUFFER_SIZE 400
+#define SHELL_TASK_STACK_SIZE 500   // words
+
+// shell_Task wake reasons, task notification bits
+#define SHELL_NOTIFY_RX_LINE  0x01   // line complete (Rx timer) or Rx queue full
+#define SHELL_NOTIFY_HEALTH   0x02   // watchdog health request
+#define SHELL_CMD_BUDGET_US  50000
 
 //commads and its size
 #define SHELL_CMD_LAT      "lat="
@@ -32,13 +38,22 @@ extern "C" {
 #define SHELL_CMD_RAD_SIZE 4
 #define SHELL_CMD_GET_DATA      "data"
 #define SHELL_CMD_GET_DATA_SIZE 4
-
-
-typedef struct
-{
-  bool bRxFromBle;
-  bool bHealthRequest;
-} sShellWakeupReason;
+#define SHELL_CMD_PERF          "perf"
+#define SHELL_CMD_PERF_SIZE     4
+#define SHELL_CMD_PERF_RESET      "perfrst"
+#define SHELL_CMD_PERF_RESET_SIZE 7
+#define SHELL_CMD_LOW_POWER       "lp"
+#define SHELL_CMD_LOW_POWER_SIZE  2
+#define SHELL_CMD_TRACE           "trace"
+#define SHELL_CMD_TRACE_SIZE      5
+#define SHELL_CMD_NMEA_BENCH      "nmea"
+#define SHELL_CMD_NMEA_BENCH_SIZE 4
+#define SHELL_CMD_BENCH           "bench"
+#define SHELL_CMD_BENCH_SIZE      5
+#define SHELL_CMD_PPS             "pps"
+#define SHELL_CMD_PPS_SIZE        3
+#define SHELL_CMD_SATS            "sats"
+#define SHELL_CMD_SATS_SIZE       4
 
 
 typedef struct
@@ -66,7 +81,6 @@ typedef struct
 typedef struct
 {
   sShellSerialPort  sUart;
-  sShellWakeupReason sWakeupReason;
 } sShellApp;
 
 
@@ -49,9 +49,13 @@
 /* Exported functions prototypes ---------------------------------------------*/
 void NMI_Handler(void);
 void HardFault_Handler(void);
+void RTC_IRQHandler(void);
 void EXTI0_1_IRQHandler(void);
 void EXTI4_15_IRQHandler(void);
 void TIM1_BRK_UP_TRG_COM_IRQHandler(void);
+void TIM2_IRQHandler(void);
+void TIM3_IRQHandler(void);
+void TIM6_DAC_IRQHandler(void);
 void USART1_IRQHandler(void);
 void USART3_8_IRQHandler(void);
 /* USER CODE BEGIN EFP */
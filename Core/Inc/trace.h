@@ -0,0 +1,69 @@
+/*******************************************************************************
+* Filename: trace.h
+* Developer: Jorge Yesid Rios Ortiz
+*******************************************************************************/
+
+#ifndef __TRACE_H
+#define __TRACE_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Included from FreeRTOSConfig.h, keep it free of HAL and kernel headers */
+#include "stdint.h"
+
+
+// Off unless the build defines it (-DTRACE_ACTIVE=1): every context switch and
+// traced interrupt pays for one event, and the ring takes 2KB of RAM
+#ifndef TRACE_ACTIVE
+  #define TRACE_ACTIVE         0     // 0: trace macros compile to nothing
+#endif
+#define TRACE_PROMPT           "TRACE"
+#define TRACE_RING_SIZE        256   // events, power of two (8 bytes each)
+#define TRACE_MAX_TASKS        12
+#define TRACE_TASK_NAME_LEN    12
+
+// event types
+#define TRACE_EVT_TASK_IN        1   // id: task number
+#define TRACE_EVT_ISR_ENTER      2   // id: TRACE_ISR_xxx
+#define TRACE_EVT_ISR_EXIT       3   // id: TRACE_ISR_xxx
+#define TRACE_EVT_QUEUE_ISR      4   // param: low half of the queue address
+#define TRACE_EVT_NOTIFY_ISR     5   // id: notified task number
+#define TRACE_EVT_USER           6   // id/param: free
+
+// interrupt sources
+#define TRACE_ISR_USART1         1
+#define TRACE_ISR_USART3         2
+#define TRACE_ISR_EXTI_PPS       3
+#define TRACE_ISR_EXTI_BUTTON    4
+
+
+typedef struct
+{
+  uint32_t u32TimeUs;
+  uint8_t  u8Type;
+  uint8_t  u8Id;
+  uint16_t u16Param;
+} sTraceEvent;
+
+
+void trace_Record(uint8_t u8Type, uint8_t u8Id, uint16_t u16Param);
+void trace_TaskCreated(uint32_t u32Number, const char *pName);
+void trace_Dump(void);
+
+
+#if (1==TRACE_ACTIVE)
+  #define TRACE_ISR_ENTER(id)   trace_Record(TRACE_EVT_ISR_ENTER, (id), 0)
+  #define TRACE_ISR_EXIT(id)    trace_Record(TRACE_EVT_ISR_EXIT, (id), 0)
+#else
+  #define TRACE_ISR_ENTER(id)
+  #define TRACE_ISR_EXIT(id)
+#endif
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __TRACE_H */
@@ -3,219 +3,284 @@
 * Developer(s): Jorge Yesid Rios Ortiz
 *******************************************************************************/
 
+#include <inttypes.h>
 #include "iwdg.h"
+#include "tim.h"
+#include "lowPower.h"
 #include "WDT_Check.h"
-#include "gps.h"
-#include "shell.h"
-#include "checkPosition.h"
 
 
-IWDG_HandleTypeDef hiwdg;
-
 /*local variables*/
 TaskHandle_t WDTCheck_TaskHandle = NULL;
-WDTCheck * pWdtCheck = NULL;
+WDTCheck WdtCheck;            // LED feedback state, driven by TIM2 CH1
+sWDTCheck_Health WdtHealth;   // registered tasks and health round state
+StaticTask_t WDTCheck_TaskBuffer;                          // task control block
+StackType_t WDTCheck_TaskStack[WDT_CHECK_TASK_STACK_SIZE]; // task stack
+StaticEventGroup_t WDTCheck_EventsBuffer;                  // health event group
 
 extern __IO uint32_t uwTick;
 
 void WDTCheck_Task(void *pvParameters);
+bool WDTCheck_HealthRound(void);
+void WDTCheck_LedSetPeriod(uint16_t u16Period);
+void WDTCheck_HealthFault(void);
+void WDTCheck_Refresh(void);
+uint32_t WDTCheck_LedMsToToggle(void);
+void WDTCheck_LedAdvance(uint32_t u32Ms);
 
 
 void WDTCheck_InitFW(void)
 {
-  xTaskCreate(WDTCheck_Task,         // Function that implements the task.
-              "wdt",                 // Text name for the task.
-              250,                   // Stack size in words, not bytes.
-              (void*) 1,             // Parameter passed into the task.
-              osPriorityNormal,      // Priority at which the task is created.
-              &WDTCheck_TaskHandle); // Used to pass out the created task's handle.
-}
-
-
-void WDTCheck_Task(void *pvParameters)
-{
-  WDTCheck WdtCheck;
-  pWdtCheck = &WdtCheck;
-
+  if (NULL==WdtHealth.xEvents)
+  {
+    WdtHealth.xEvents = xEventGroupCreateStatic(&WDTCheck_EventsBuffer);
+  }
   WdtCheck.bUsePermanentValue = true;
   WdtCheck.u8TimesBeforeReturn = 0;
   WdtCheck.u16PeriodCurrent = WDT_CHECK_PERIOD;
   WdtCheck.u16PeriodTemp = 0;
+  WdtCheck.bStopInhibit = false;
+  WDTCheck_LedSetPeriod(WdtCheck.u16PeriodCurrent);
+  HAL_TIM_OC_Start(&htim2, TIM_CHANNEL_1);  // LED toggles in hardware from now on
+  lowPower_RegisterTimer(WDTCheck_LedMsToToggle, WDTCheck_LedAdvance);
+
+  WDTCheck_TaskHandle = xTaskCreateStatic(WDTCheck_Task, // Function that implements the task.
+              "wdt",                     // Text name for the task.
+              WDT_CHECK_TASK_STACK_SIZE, // Stack size in words, not bytes.
+              (void*) 1,                 // Parameter passed into the task.
+              osPriorityNormal,          // Priority at which the task is created.
+              WDTCheck_TaskStack,        // Stack buffer.
+              &WDTCheck_TaskBuffer);     // Task control block.
+  if ((NULL==WDTCheck_TaskHandle) || (NULL==WdtHealth.xEvents))
+  {
+    Error_Handler();
+  }
+}
 
-  WdtCheck.sHealth.u16CounterProcess = 0;
-  WdtCheck.sHealth.bCheckProcess = false;
-  WdtCheck.sHealth.bLaunchProcess = false;
-  WdtCheck.sHealth.sTask.Register = WDT_CHECK_WATCHED_TASKS;
 
+void WDTCheck_Task(void *pvParameters)
+{
   vTaskDelay(300);
+  lowPower_Calibrate();  // STOP mode is allowed from here on
   printf("WDT task Ok\r\n");
   #if 1==DEBUG_WDT_CHECK_ACTIVE
-    uint8_t u8Taskfields = 0;
-    uint16_t u16counterWdt = 0;
     MX_IWDG_Init();
   #endif
+  WdtHealth.xLastRound = xTaskGetTickCount();
   for (;;)
   {
-    if ( true==WdtCheck.bUsePermanentValue)
-    {
-      HAL_GPIO_TogglePin(LD2_GPIO_Port, LD2_Pin);
-      vTaskDelay(WdtCheck.u16PeriodCurrent);
-      #if 1==DEBUG_WDT_CHECK_ACTIVE
-        HAL_IWDG_Refresh(&hiwdg);
-      #endif
-    }
-    else
+    vTaskDelay(WDT_CHECK_REFRESH_PERIOD);
+    WDTCheck_Refresh();
+    if ((xTaskGetTickCount() - WdtHealth.xLastRound) >= pdMS_TO_TICKS(WDT_CHECK_HEALTH_PERIOD))
     {
-      do
+      if (false==WDTCheck_HealthRound())
       {
-        HAL_GPIO_TogglePin(LD2_GPIO_Port, LD2_Pin);
-        vTaskDelay(WdtCheck.u16PeriodTemp);
-        WdtCheck.u8TimesBeforeReturn--;
+        WDTCheck_HealthFault();
         #if 1==DEBUG_WDT_CHECK_ACTIVE
-          HAL_IWDG_Refresh(&hiwdg);
+          while(1)  // stop refreshing, the IWDG resets the board
+          {
+            vTaskDelay(50);
+          }
         #endif
       }
-      while (0<WdtCheck.u8TimesBeforeReturn);
-      WdtCheck.bUsePermanentValue = true;
+      WDTCheck_Refresh();
     }
+  }
+}
 
-    #if 1==DEBUG_WDT_CHECK_ACTIVE
-      HAL_IWDG_Refresh(&hiwdg);
-      WdtCheck.sHealth.u16CounterProcess++;
-      if(WDT_CHECK_COUNTER == WdtCheck.sHealth.u16CounterProcess)
-      {
-        u8Taskfields = WDT_CHECK_WATCHED_TASKS;
-        WdtCheck.sHealth.u8TaskToCheck = u8Taskfields;
-        #if (1==WDT_CHECK_DEBUG)
-          printf("%s> fields to check: %d <%04d>\r\n", WDT_CHECK_PROMPT, u8Taskfields, u16counterWdt);
-        #endif
-        for (char u8CntFields = 0; u8CntFields < 32; u8CntFields++)
-        {
-        if((u8Taskfields & 0x01) == 0x01)
-        {
-            WDTCheck_HealthRequest(u8CntFields);
-        }
-          u8Taskfields = u8Taskfields >> 1;
-          vTaskDelay(50);
-          HAL_IWDG_Refresh(&hiwdg);
-        }
-      }
-      if(WDT_REQUEST_COUNTER == WdtCheck.sHealth.u16CounterProcess)
-      {
-        #if (1==WDT_CHECK_DEBUG)
-          printf("%s> checked-responsed Tasks : %d-%d [%lu] <%04d>\r\n", WDT_CHECK_PROMPT, WdtCheck.sHealth.u8TaskToCheck, WdtCheck.sHealth.sTask.Register, uwTick, u16counterWdt++);
-        #endif
-        if(WdtCheck.sHealth.u8TaskToCheck != WdtCheck.sHealth.sTask.Register)
-        {
-          while(1)
-          {
-              vTaskDelay(50);
-          }
-        }
-        WdtCheck.sHealth.sTask.Register = 0;
-      }
-      if(WDT_MAX_COUNTER <= WdtCheck.sHealth.u16CounterProcess)
-      {
-        WdtCheck.sHealth.u16CounterProcess = 0;
-      }
-    #endif
+
+// Without the IWDG the rounds still run, a silent task is only reported
+void WDTCheck_Refresh(void)
+{
+  #if 1==DEBUG_WDT_CHECK_ACTIVE
+    HAL_IWDG_Refresh(&hiwdg);
+  #endif
+}
+
+
+/*
+ * One health round: every registered task gets its request at once and the
+ * watchdog blocks a single time until all bits are set or the deadline expires.
+ */
+bool WDTCheck_HealthRound(void)
+{
+  EventBits_t uxAnswered = 0;
+  TickType_t xStart = xTaskGetTickCount();
+
+  WdtHealth.xLastRound = xStart;
+  if (NULL==WdtHealth.xEvents || 0==WdtHealth.uxRegistered)
+  {
+    return true;
+  }
+
+  xEventGroupClearBits(WdtHealth.xEvents, WdtHealth.uxRegistered);
+  for (uint8_t u8Id = 0; u8Id < WdtHealth.u8TaskCount; u8Id++)
+  {
+    WdtHealth.pfRequest[u8Id]();
   }
+  uxAnswered = xEventGroupWaitBits(WdtHealth.xEvents,
+                                   WdtHealth.uxRegistered,
+                                   pdTRUE,    // clear the bits on exit
+                                   pdTRUE,    // wait for every task
+                                   pdMS_TO_TICKS(WDT_CHECK_HEALTH_DEADLINE));
+  uxAnswered &= WdtHealth.uxRegistered;
+  WdtHealth.uxLastAnswered = uxAnswered;
+  WdtHealth.u32LastRoundTicks = xTaskGetTickCount() - xStart;
+  WdtHealth.u32Rounds++;
+  #if (1==WDT_CHECK_DEBUG)
+    printf("%s> checked-responsed Tasks : %" PRIu32 "-%" PRIu32 " [%" PRIu32 " ms] <%04" PRIu32 ">\r\n", WDT_CHECK_PROMPT,
+           (uint32_t)WdtHealth.uxRegistered, (uint32_t)uxAnswered,
+           WdtHealth.u32LastRoundTicks, WdtHealth.u32Rounds);
+  #endif
+  return (uxAnswered == WdtHealth.uxRegistered);
+}
+
+
+// Names the tasks that did not answer the last round
+void WDTCheck_HealthFault(void)
+{
+  EventBits_t uxSilent = WdtHealth.uxRegistered & ~WdtHealth.uxLastAnswered;
+
+  printf("%s> silent tasks 0x%02" PRIX32 "\r\n", WDT_CHECK_PROMPT, (uint32_t)uxSilent);
 }
 
 
+/*
+ * Changes the LED toggle period. Permanent periods stay until the next call,
+ * temporary ones toggle u8Times times and then return to the permanent period.
+ */
 void WDTCheck_Period(bool bIsPermanent, uint16_t u16Period, uint8_t u8Times)
 {
-  if (NULL==WDTCheck_TaskHandle)
+  if (NULL==htim2.Instance || 0==u16Period)
   {
     return;
   }
 
-  pWdtCheck->bUsePermanentValue = bIsPermanent;
-  if (true == bIsPermanent)
+  // STOP would wake at every toggle of a fast blink, SLEEP costs less there
+  if ((WDT_CHECK_PERIOD_500 >= u16Period) != WdtCheck.bStopInhibit)
   {
-    pWdtCheck->u16PeriodCurrent = u16Period;
-    pWdtCheck->u16PeriodTemp = 0;
-    pWdtCheck->u8TimesBeforeReturn = 0;
+    WdtCheck.bStopInhibit = (WDT_CHECK_PERIOD_500 >= u16Period);
+    lowPower_StopInhibit(WdtCheck.bStopInhibit);
+  }
+
+  __HAL_TIM_DISABLE_IT(&htim2, TIM_IT_UPDATE);
+  if (true == bIsPermanent || 0 == u8Times)
+  {
+    WdtCheck.bUsePermanentValue = true;
+    if (true == bIsPermanent)
+    {
+      WdtCheck.u16PeriodCurrent = u16Period;
+    }
+    WdtCheck.u16PeriodTemp = 0;
+    WdtCheck.u8TimesBeforeReturn = 0;
+    WDTCheck_LedSetPeriod(WdtCheck.u16PeriodCurrent);
   }
   else
   {
-    pWdtCheck->u16PeriodTemp = u16Period;
-    pWdtCheck->u8TimesBeforeReturn = u8Times;
+    WdtCheck.bUsePermanentValue = false;
+    WdtCheck.u16PeriodTemp = u16Period;
+    WdtCheck.u8TimesBeforeReturn = u8Times;
+    WDTCheck_LedSetPeriod(u16Period);
+    __HAL_TIM_CLEAR_IT(&htim2, TIM_IT_UPDATE);
+    __HAL_TIM_ENABLE_IT(&htim2, TIM_IT_UPDATE);
   }
 }
 
 
-void WDTCheck_HealthRequest(char code)
+/*
+ * TIM2 update interrupt, only enabled while a temporary period is running.
+ * Every update is one LED toggle.
+ */
+void WDTCheck_LedPeriodElapsed(void)
 {
-  switch (code)
+  if (true == WdtCheck.bUsePermanentValue)
   {
-    case WDT_CHECK_TASK_GPS_CODE:
-    {
-      gps_HealthRequest();
-      break;
-    }
-    case WDT_CHECK_TASK_SHELL_CODE:
-    {
-      shell_HealthRequest();
-      break;
-    }
-    case WDT_CHECK_TASK_CHECK_POS_CODE:
-    {
-      checkPos_HealthRequest();
-      break;
-    }
-
-    default:
-    {
-      while(1);
-    }
+    __HAL_TIM_DISABLE_IT(&htim2, TIM_IT_UPDATE);
+    return;
+  }
+  if (0 < WdtCheck.u8TimesBeforeReturn)
+  {
+    WdtCheck.u8TimesBeforeReturn--;
+  }
+  if (0 == WdtCheck.u8TimesBeforeReturn)
+  {
+    __HAL_TIM_DISABLE_IT(&htim2, TIM_IT_UPDATE);
+    WdtCheck.bUsePermanentValue = true;
+    WDTCheck_LedSetPeriod(WdtCheck.u16PeriodCurrent);
   }
+}
+
 
+void WDTCheck_LedSetPeriod(uint16_t u16Period)
+{
+  // ARR is preloaded, the new period starts at the next update without a glitch
+  __HAL_TIM_SET_AUTORELOAD(&htim2, (uint32_t)u16Period - 1);
 }
 
 
-void WDTCheck_HealthResponse(char code)
+/*
+ * TIM2 stops in STOP mode. The low power module ends STOP before the next
+ * toggle (1ms per count) and then moves the counter on by the time slept,
+ * so the blink keeps its period.
+ */
+uint32_t WDTCheck_LedMsToToggle(void)
 {
-  HAL_IWDG_Refresh(&hiwdg);
-  switch (code)
+  uint32_t u32Arr = __HAL_TIM_GET_AUTORELOAD(&htim2);
+  uint32_t u32Cnt = __HAL_TIM_GET_COUNTER(&htim2);
+
+  return (u32Cnt < u32Arr) ? (u32Arr - u32Cnt + 1) : 1;
+}
+
+
+void WDTCheck_LedAdvance(uint32_t u32Ms)
+{
+  uint32_t u32Arr = __HAL_TIM_GET_AUTORELOAD(&htim2);
+  uint32_t u32Cnt = __HAL_TIM_GET_COUNTER(&htim2);
+
+  // The toggle itself stays with the hardware, at most up to the last count
+  u32Cnt = ((u32Arr - u32Cnt) > u32Ms) ? (u32Cnt + u32Ms) : u32Arr;
+  __HAL_TIM_SET_COUNTER(&htim2, u32Cnt);
+}
+
+
+/*
+ * Adds a task to the health rounds. Must be called before the scheduler starts.
+ * Returns the bit the task answers with, or WDT_CHECK_INVALID_ID when full.
+ */
+uint8_t WDTCheck_RegisterTask(pfWDTCheck_HealthRequest pfRequest)
+{
+  uint8_t u8Id = WdtHealth.u8TaskCount;
+  if (NULL==pfRequest || WDT_CHECK_MAX_TASKS<=u8Id)
   {
-    case WDT_CHECK_TASK_GPS_CODE:
-    {
-      pWdtCheck->sHealth.sTask.Task.t0 = 1;
-      break;
-    }
-    case WDT_CHECK_TASK_SHELL_CODE:
-    {
-      pWdtCheck->sHealth.sTask.Task.t1 = 1;
-      break;
-    }
-    case WDT_CHECK_TASK_CHECK_POS_CODE:
-    {
-      pWdtCheck->sHealth.sTask.Task.t2 = 1;
-      break;
-    }
-    default:
-    {
-      while(1);
-    }
+    return WDT_CHECK_INVALID_ID;
+  }
+  WdtHealth.pfRequest[u8Id] = pfRequest;
+  WdtHealth.uxRegistered |= ((EventBits_t)1 << u8Id);
+  WdtHealth.u8TaskCount++;
+  return u8Id;
+}
+
+
+void WDTCheck_HealthResponse(uint8_t u8TaskId)
+{
+  if (NULL==WdtHealth.xEvents || WdtHealth.u8TaskCount<=u8TaskId)
+  {
+    return;
   }
+  xEventGroupSetBits(WdtHealth.xEvents, (EventBits_t)1 << u8TaskId);
 }
 
 
 void WDTCheck_RestartCounter(void)
 {
-  pWdtCheck->sHealth.bCheckProcess = false;
-  pWdtCheck->sHealth.bLaunchProcess = false;
-  pWdtCheck->sHealth.u8TaskToCheck = 0;
-  pWdtCheck->sHealth.sTask.Register = 0;
-  pWdtCheck->sHealth.u16CounterProcess = 0;
+  WdtHealth.xLastRound = xTaskGetTickCount();
+  if (NULL!=WdtHealth.xEvents)
+  {
+    xEventGroupClearBits(WdtHealth.xEvents, WdtHealth.uxRegistered);
+  }
 }
 
 void WDTCheck_RestartProcess(bool bIsFotActive)
 {
-  pWdtCheck->sHealth.bCheckProcess = false;
-  pWdtCheck->sHealth.bLaunchProcess = false;
-  pWdtCheck->sHealth.u8TaskToCheck = 0;
-  pWdtCheck->sHealth.sTask.Register = 0;
-  pWdtCheck->sHealth.u16CounterProcess = 0;
+  WDTCheck_RestartCounter();
 }
@@ -0,0 +1,216 @@
+/*******************************************************************************
+* Filename: bench.c
+* Developer: Jorge Yesid Rios Ortiz
+*******************************************************************************/
+
+#include <inttypes.h>
+#include <stdio.h>
+#include <string.h>
+#include "bench.h"
+#include "main.h"
+#include "perfMon.h"
+#include "gps.h"
+#include "checkPosition.h"
+
+/*
+ * Cycle count micro benchmarks. The M0 has no DWT cycle counter, so a call is
+ * timed with the SysTick current value (the kernel tick, counting down from
+ * LOAD) with interrupts masked. COUNTFLAG tells one reload happened in between.
+ * Calls longer than a tick are timed with TIM6 instead and scaled to cycles.
+ * The kernel tick is only delayed while a sample runs, never lost.
+ */
+
+sBenchItem BenchItems[BENCH_MAX_ITEMS];
+uint8_t u8BenchCount = 0;
+
+// Inputs are volatile so the compiler can not fold the benchmarked calls
+volatile double dBenchLatitude = 4.754917;
+volatile double dBenchLongitude = -74.09110;
+volatile double dBenchResult = 0;
+volatile sGpsCoordinate sBenchCoordinate;
+volatile uint32_t u32BenchEpoch = 4102444799;   // 2099-12-31 23:59:59, longest path
+sGpsDateTime sBenchDateTime = {{31, 12, 2099}, {23, 59, 59}};
+uint8_t au8BenchCoordinate[] = "07405.46637,W";
+char acBenchStdout[BENCH_SAMPLES * 16];
+
+void bench_Empty(void);
+void bench_Haversine(void);
+void bench_Coordinate(void);
+void bench_DateTimeToEpoch(void);
+void bench_EpochToDateTime(void);
+void bench_PrintfFloat(void);
+void bench_StdoutBuffered(void);
+void bench_StdoutUnbuffered(void);
+
+
+void bench_Init(void)
+{
+  u8BenchCount = 0;
+  bench_Register("empty", bench_Empty, NULL, NULL);
+  bench_Register("haversine", bench_Haversine, NULL, NULL);
+  bench_Register("gps coordinate", bench_Coordinate, NULL, NULL);
+  bench_Register("date to epoch", bench_DateTimeToEpoch, NULL, NULL);
+  bench_Register("epoch to date", bench_EpochToDateTime, NULL, NULL);
+  bench_Register("printf %f", bench_PrintfFloat, bench_StdoutBuffered, bench_StdoutUnbuffered);
+}
+
+
+/*
+ * Returns BENCH_INVALID_ID when the table is full.
+ */
+uint8_t bench_Register(const char *pName, pfBench pfRun, pfBench pfSetup, pfBench pfTeardown)
+{
+  if ((BENCH_MAX_ITEMS <= u8BenchCount) || (NULL == pfRun))
+  {
+    return BENCH_INVALID_ID;
+  }
+  BenchItems[u8BenchCount].pName = pName;
+  BenchItems[u8BenchCount].pfRun = pfRun;
+  BenchItems[u8BenchCount].pfSetup = pfSetup;
+  BenchItems[u8BenchCount].pfTeardown = pfTeardown;
+  return u8BenchCount++;
+}
+
+
+uint32_t bench_Cycles(pfBench pfRun)
+{
+  uint32_t u32Reload = SysTick->LOAD + 1;
+  uint32_t u32Primask = __get_PRIMASK();
+  uint32_t u32StartUs = 0;
+  uint32_t u32ElapsedUs = 0;
+  uint32_t u32Start = 0;
+  uint32_t u32End = 0;
+  uint32_t u32Cycles = 0;
+  bool bWrapped = false;
+
+  __disable_irq();
+  u32StartUs = perfMon_GetUs();
+  (void)SysTick->CTRL;   // reading clears COUNTFLAG
+  u32Start = SysTick->VAL;
+  pfRun();
+  u32End = SysTick->VAL;
+  bWrapped = (0 != (SysTick->CTRL & SysTick_CTRL_COUNTFLAG_Msk));
+  u32ElapsedUs = perfMon_GetUs() - u32StartUs;
+  __set_PRIMASK(u32Primask);
+
+  u32Cycles = (false == bWrapped) ? (u32Start - u32End) : (u32Start + (u32Reload - u32End));
+  if ((u32ElapsedUs * (SystemCoreClock / 1000000)) >= (u32Reload / 2))
+  {
+    u32Cycles = u32ElapsedUs * (SystemCoreClock / 1000000);   // may have wrapped more than once
+  }
+  return u32Cycles;
+}
+
+
+void bench_Run(uint8_t u8Id, sBenchResult *pResult)
+{
+  uint32_t au32Samples[BENCH_SAMPLES];
+  uint32_t u32Temp = 0;
+  uint8_t u8Pos = 0;
+
+  if (u8BenchCount <= u8Id)
+  {
+    memset(pResult, 0, sizeof(sBenchResult));
+    return;
+  }
+  if (NULL != BenchItems[u8Id].pfSetup)
+  {
+    BenchItems[u8Id].pfSetup();
+  }
+  for (uint8_t u8Sample = 0; u8Sample < BENCH_SAMPLES; u8Sample++)
+  {
+    au32Samples[u8Sample] = bench_Cycles(BenchItems[u8Id].pfRun);
+  }
+  if (NULL != BenchItems[u8Id].pfTeardown)
+  {
+    BenchItems[u8Id].pfTeardown();
+  }
+
+  for (uint8_t u8Sample = 1; u8Sample < BENCH_SAMPLES; u8Sample++)   // insertion sort
+  {
+    u32Temp = au32Samples[u8Sample];
+    u8Pos = u8Sample;
+    while ((0 < u8Pos) && (au32Samples[u8Pos - 1] > u32Temp))
+    {
+      au32Samples[u8Pos] = au32Samples[u8Pos - 1];
+      u8Pos--;
+    }
+    au32Samples[u8Pos] = u32Temp;
+  }
+  pResult->u32Min = au32Samples[0];
+  pResult->u32Median = au32Samples[BENCH_SAMPLES / 2];
+  pResult->u32Max = au32Samples[BENCH_SAMPLES - 1];
+}
+
+
+/*
+ * Cycles include the call through the function pointer, see the "empty" row.
+ */
+void bench_Print(void)
+{
+  sBenchResult sResult;
+
+  printf("%s> %" PRIu32 " samples, %" PRIu32 "MHz core, cycles min/median/max\r\n", BENCH_PROMPT,
+         (uint32_t)BENCH_SAMPLES, SystemCoreClock / 1000000);
+  for (uint8_t u8Id = 0; u8Id < u8BenchCount; u8Id++)
+  {
+    bench_Run(u8Id, &sResult);
+    printf("%s> %s: %" PRIu32 " / %" PRIu32 " / %" PRIu32 "\r\n", BENCH_PROMPT, BenchItems[u8Id].pName,
+           sResult.u32Min, sResult.u32Median, sResult.u32Max);
+  }
+}
+
+
+void bench_Empty(void)
+{
+}
+
+
+// Former self test of main.c: fixed point near the default target
+void bench_Haversine(void)
+{
+  dBenchResult = checkPos_Haversine(dBenchLatitude, dBenchLongitude, 4.752554848, -74.08948412,
+                                    CHECK_POS_EARTH_RAD_DEFAULT);
+}
+
+
+void bench_Coordinate(void)
+{
+  sBenchCoordinate = gps_ExtractCoordinate(au8BenchCoordinate);
+}
+
+
+void bench_DateTimeToEpoch(void)
+{
+  u32BenchEpoch = gps_DateTimeToEpoch(&sBenchDateTime);
+}
+
+
+void bench_EpochToDateTime(void)
+{
+  gps_EpochToDateTime(u32BenchEpoch, &sBenchDateTime);
+}
+
+
+/*
+ * stdout is fully buffered while the samples run, so only the float formatting
+ * of newlib is timed and not the UART. The teardown flushes the line.
+ */
+void bench_PrintfFloat(void)
+{
+  printf("%f\r", dBenchLatitude);
+}
+
+
+void bench_StdoutBuffered(void)
+{
+  fflush(stdout);
+  setvbuf(stdout, acBenchStdout, _IOFBF, sizeof(acBenchStdout));
+}
+
+
+void bench_StdoutUnbuffered(void)
+{
+  fflush(stdout);
+  setvbuf(stdout, NULL, _IONBF, 0);
+}
@@ -12,8 +12,11 @@
 #include "WDT_Check.h"
 #include "string.h"
 #include "gps.h"
+#include "perfMon.h"
 
 #define CHECK_POS_CHECK_DISTANCE       5000
+#define CHECK_POS_BUDGET_US           20000   // distance math plus one console line
+#define CHECK_POS_TASK_STACK_SIZE       250   // words
 
 
 #define CHECK_POS_BLINK_NO_CFG   1500
@@ -26,8 +29,13 @@
 
 
 TaskHandle_t checkPosHandleTask = NULL;      //Task Handle
-SemaphoreHandle_t checkPosSemaphore = NULL;  //task's Semaphore Handle
 TimerHandle_t checkPosTimer = NULL;          //Timer Tx Handle
+uint8_t checkPosWdtId = WDT_CHECK_INVALID_ID; //health bit given by the watchdog
+uint8_t checkPosPerfId = PERF_MON_INVALID_ID;  //distance check latency
+
+StaticTask_t checkPosTaskBuffer;                           //task control block
+StackType_t checkPosTaskStack[CHECK_POS_TASK_STACK_SIZE];  //task stack
+StaticTimer_t checkPosTimerBuffer;                         //timer control block
 
 sCheckPosApp sCheckPos;
 
@@ -44,28 +52,37 @@ void checkPos_InitFw(void)
   //BaseType_t xReturned;
   if(NULL == checkPosHandleTask)
   {
-    xTaskCreate(checkPos_Task, // Function that implements the task
+    checkPosHandleTask = xTaskCreateStatic(checkPos_Task, // Function that implements the task
     "checkPos",                // Text name for the task
-    250,                       // Stack size in words, not bytes
+    CHECK_POS_TASK_STACK_SIZE, // Stack size in words, not bytes
     (void*) 1,                 // Parameter passed into the task
     osPriorityNormal,          // Priority at which the task is created
-    &checkPosHandleTask);      // Used to pass out the created task's handle
+    checkPosTaskStack,         // Stack buffer
+    &checkPosTaskBuffer);      // Task control block
+    if(NULL == checkPosHandleTask)
+    {
+      Error_Handler();
+    }
+    checkPosWdtId = WDTCheck_RegisterTask(checkPos_HealthRequest);
+    checkPosPerfId = perfMon_Register("distance check", CHECK_POS_BUDGET_US);
   }
 }
 
 
 void checkPos_Task(void *pvParameters)
 {
+  uint32_t u32Notify = 0;
   checkPos_ResetVariables();
-  if(NULL == checkPosSemaphore)
+
+  if(NULL == checkPosTimer)
   {
-    checkPosSemaphore = xSemaphoreCreateBinary();
+    checkPosTimer = xTimerCreateStatic("TimerRxFromBle", CHECK_POS_CHECK_DISTANCE, pdTRUE,
+        (void*) 0, checkPos_TimerCallback, &checkPosTimerBuffer);
   }
 
   if(NULL == checkPosTimer)
   {
-    checkPosTimer = xTimerCreate("TimerRxFromBle", CHECK_POS_CHECK_DISTANCE, pdTRUE,
-        (void*) 0, checkPos_TimerCallback);
+    Error_Handler();
   }
 
   vTaskDelay(400);
@@ -79,17 +96,17 @@ void checkPos_Task(void *pvParameters)
   }
   for (;;)
   {
-    if(xSemaphoreTake(checkPosSemaphore, portMAX_DELAY) == pdTRUE)
+    if(xTaskNotifyWait(0, UINT32_MAX, &u32Notify, portMAX_DELAY) == pdTRUE)
     {
-      if(true == sCheckPos.sWakeupReason.bTimer)
+      if(0 != (u32Notify & CHECK_POS_NOTIFY_TIMER))
       {
-        sCheckPos.sWakeupReason.bTimer = false;
+        perfMon_Begin(checkPosPerfId);
         checkPos_CheckDistance();
+        perfMon_End(checkPosPerfId);
       }
-      if(true == sCheckPos.sWakeupReason.bHealthRequest)
+      if(0 != (u32Notify & CHECK_POS_NOTIFY_HEALTH))
       {
-        sCheckPos.sWakeupReason.bHealthRequest = false;
-        WDTCheck_HealthResponse(WDT_CHECK_TASK_CHECK_POS_CODE);
+        WDTCheck_HealthResponse(checkPosWdtId);
       }
     }
   }
@@ -102,9 +119,7 @@ void checkPos_ResetVariables(void)
   sCheckPos.dLongitude = 0;
   sCheckPos.dDistance = 0;
   sCheckPos.dEarthRad = CHECK_POS_EARTH_RAD_DEFAULT;
-  sCheckPos.sWakeupReason.bTimer = false;
   sCheckPos.sDoCheck.Register = 0;
-  sCheckPos.sWakeupReason.bHealthRequest = false;
   WDTCheck_Period(true, CHECK_POS_BLINK_NO_CFG, 0);
 }
 
@@ -121,6 +136,20 @@ void checkPos_PrintHelp(void)
   printf("get parameters\r\n");
   printf("   data\r\n");
   printf("  parameters: Point:[lat,log] Radius:<radius> Kms  <==Response\r\n");
+  printf("latency histograms (print / clear)\r\n");
+  printf("   perf / perfrst\r\n");
+  printf("STOP mode statistics and duty cycle\r\n");
+  printf("   lp\r\n");
+  printf("dump the kernel trace (tools/trace2chrome.py)\r\n");
+  printf("   trace\r\n");
+  printf("replay the built-in NMEA corpus, CSV timing per decoder stage\r\n");
+  printf("   nmea\r\n");
+  printf("cycles per call of the registered micro benchmarks\r\n");
+  printf("   bench\r\n");
+  printf("PPS timebase: lock, HSI drift and UTC to the microsecond\r\n");
+  printf("   pps\r\n");
+  printf("satellites per constellation (GSV) and talker of the fix\r\n");
+  printf("   sats\r\n");
 }
 
 
@@ -144,13 +173,8 @@ void checkPos_CheckDistance(void)
     return;
   }
   printf("%s> GPS:[%f,%f]", CHECK_POS_PROMPT, dLatitudeDD, dLongitudeDD);
-  double difLatitude =  (dLatitudeDD  - sCheckPos.dLatitude)   *M_PI/180;
-  double difLongitude = (dLongitudeDD - sCheckPos.dLongitude)  *M_PI/180;
-  dLatitudeDD  *= M_PI/180;
-  dLongitudeDD *= M_PI/180;
-  sCheckPos.dDistance = pow(sin(difLatitude / 2), 2) +
-                        pow(sin(difLongitude / 2), 2) * cos(dLatitudeDD*M_PI/180) * cos(sCheckPos.dLatitude*M_PI/180);
-  sCheckPos.dDistance = 2 * sCheckPos.dEarthRad * asin(sqrt(sCheckPos.dDistance))*1000;
+  sCheckPos.dDistance = checkPos_Haversine(dLatitudeDD, dLongitudeDD, sCheckPos.dLatitude,
+                                           sCheckPos.dLongitude, sCheckPos.dEarthRad);
   printf(" TARGET:[%f,%f]  Distance:%.2f m %s\r\n",
 									 sCheckPos.dLatitude, sCheckPos.dLongitude,
 									 sCheckPos.dDistance,
@@ -182,6 +206,23 @@ void checkPos_CheckDistance(void)
 }
 
 
+/*
+ * Distance in meters between the gps point (A) and the target (B), both in
+ * decimal degrees. No side effects, so it can be benchmarked.
+ */
+double checkPos_Haversine(double dLatA, double dLonA, double dLatB, double dLonB, double dEarthRad)
+{
+  double dDistance = 0;
+  double difLatitude =  (dLatA - dLatB) *M_PI/180;
+  double difLongitude = (dLonA - dLonB) *M_PI/180;
+  dLatA *= M_PI/180;
+  dLonA *= M_PI/180;
+  dDistance = pow(sin(difLatitude / 2), 2) +
+              pow(sin(difLongitude / 2), 2) * cos(dLatA*M_PI/180) * cos(dLatB*M_PI/180);
+  return 2 * dEarthRad * asin(sqrt(dDistance))*1000;
+}
+
+
 bool checkPos_SetLatitude(double dLat)
 {
   if( (dLat >= -90) && (dLat <=  90) )
@@ -238,21 +279,19 @@ double checkPos_GetEarthRadius(void)
 
 void checkPos_HealthRequest(void)
 {
-  if(NULL == checkPosHandleTask || NULL == checkPosSemaphore)
+  if(NULL == checkPosHandleTask)
   {
     return;
   }
-  sCheckPos.sWakeupReason.bHealthRequest = true;
-  xSemaphoreGive(checkPosSemaphore);
+  xTaskNotify(checkPosHandleTask, CHECK_POS_NOTIFY_HEALTH, eSetBits);
 }
 
 
 void checkPos_TimerCallback(TimerHandle_t xTimer)
 {
-  if(NULL == checkPosHandleTask || NULL == checkPosSemaphore)
+  if(NULL == checkPosHandleTask)
   {
     return;
   }
-  sCheckPos.sWakeupReason.bTimer = true;
-  xSemaphoreGive(checkPosSemaphore);
+  xTaskNotify(checkPosHandleTask, CHECK_POS_NOTIFY_TIMER, eSetBits);
 }
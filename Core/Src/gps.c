@@ -9,34 +9,37 @@
 #include "gpio.h"
 #include "usart.h"
 #include "WDT_Check.h"
-
-extern TIM_HandleTypeDef htim3;
-#define TIMER &htim3
-#define TIMER_INSTANCE   htim3.Instance
+#include "perfMon.h"
+#include "ppsClock.h"
+#include "lowPower.h"
 
 TaskHandle_t gpsTaskHandle = NULL;           // freeRTOS task handle
 QueueHandle_t gpsRxQueue = NULL;             // freeRTOS handle for GPS Rx Queue
-SemaphoreHandle_t gpsSemaphoreHandle = NULL; // freeRTOS handle for GPS Rx Semaphore
+uint8_t gpsWdtId = WDT_CHECK_INVALID_ID;     // health bit given by the watchdog
+uint8_t gpsPerfId = PERF_MON_INVALID_ID;     // per sentence decode latency
+volatile bool gpsPpsStopInhibit = false;     // STOP held off while the PPS timebase runs
+
+StaticTask_t gpsTaskBuffer;                      // task control block
+StackType_t gpsTaskStack[GPS_TASK_STACK_SIZE];   // task stack
+StaticQueue_t gpsRxQueueBuffer;                  // Rx queue control block
+uint8_t gpsRxQueueStorage[GPS_RX_QUEUE_SIZE];    // Rx queue storage
 
 sGpsData GpsData;             // gps data with validation
 sGpsDataFromGps  GpsDataRaw;  // Temporal gps data without validation
 sGpsValidationParameters  GpsValidationParameters; // Parameters to gps validation
+uint64_t gpsLastTimeMs = 0;   // last gps_GetTimeMs, keeps it monotonic
 
 void gps_InitHw(void);
 void gps_InitValidationParameters(void);
 
 void gps_FrameDecoder(void);
+bool gps_TimeInWindow(uint32_t u32Epoch);
+bool gps_GnssFixIsRecent(void);
+uint8_t gps_ExtractUint8(uint8_t *pData);
 uint8_t *gps_GetNextToken(uint8_t * pData);
-uint8_t gps_FrameOfInterest(uint8_t *pData);
-bool gps_VerifyChecksumNmea(unsigned char * pData);
-
-void gps_ExtractDataRMC(uint8_t *pframe);
-bool gps_ValidationNMEAData(void);
-void gps_UpdateGpsData(void);
 
 void gps_ExtractTime(uint8_t *pData);
 void gps_ExtractDate(uint8_t *pData);
-sGpsCoordinate gps_ExtractCoordinate(uint8_t *pData);
 
 uint8_t gps_HexaCharToAscii(uint8_t uHexa);
 
@@ -45,12 +48,19 @@ void gps_InitFw(void)
 {
   if (NULL==gpsTaskHandle)
   {
-    xTaskCreate(gps_Task,         // Function that implements the task
-                "Gps",            // Text name for the task
-                200,              // Stack size in words, not bytes
-                (void *) 1,       // Parameter passed into the task
-                osPriorityNormal, // Priority at which the task is created
-                &gpsTaskHandle);  // Used to pass out the created task's handle
+    gpsTaskHandle = xTaskCreateStatic(gps_Task, // Function that implements the task
+                "Gps",                  // Text name for the task
+                GPS_TASK_STACK_SIZE,    // Stack size in words, not bytes
+                (void *) 1,             // Parameter passed into the task
+                osPriorityNormal,       // Priority at which the task is created
+                gpsTaskStack,           // Stack buffer
+                &gpsTaskBuffer);        // Task control block
+    if (NULL==gpsTaskHandle)
+    {
+      Error_Handler();
+    }
+    gpsWdtId = WDTCheck_RegisterTask(gps_HealthRequest);
+    gpsPerfId = perfMon_Register("gps decode", GPS_DECODE_BUDGET_US);
   }
 }
 
@@ -67,19 +77,19 @@ void gps_InitHw(void)
 void gps_Task(void * argument)
 {
   uint8_t gpsFirstByte = 0;
-  GpsData.bHealthRequest = false;
+  uint32_t u32Notify = 0;
 
   printf("Init GPS\r\n");
 
-
-  if (NULL==gpsSemaphoreHandle)
+  if (NULL==gpsRxQueue)
   {
-    gpsSemaphoreHandle = xSemaphoreCreateBinary();
+    gpsRxQueue = xQueueCreateStatic(GPS_RX_QUEUE_SIZE, sizeof(uint8_t), gpsRxQueueStorage,
+                                    &gpsRxQueueBuffer);
   }
 
   if (NULL==gpsRxQueue)
   {
-    gpsRxQueue = xQueueCreate(GPS_RX_QUEUE_SIZE, sizeof(uint8_t));
+    Error_Handler();
   }
 
   gps_InitValidationParameters(); // validation parameters setup
@@ -88,21 +98,33 @@ void gps_Task(void * argument)
   printf("GPS Task Ok\r\n");
   for (;;)
   {
-    if( xSemaphoreTake( gpsSemaphoreHandle, portMAX_DELAY ) == pdTRUE) // wait until \n arrives from UART
+    if( xTaskNotifyWait(0, UINT32_MAX, &u32Notify, portMAX_DELAY) == pdTRUE) // wait until \n arrives from UART
     {
-      if( xQueueReceive( gpsRxQueue, &gpsFirstByte, portMAX_DELAY ) == pdTRUE )
+      if (0 != (u32Notify & GPS_NOTIFY_RX_LINE))
       {
-        if(gpsFirstByte == '$')  // Verifies the head of Frame
+        if( xQueueReceive( gpsRxQueue, &gpsFirstByte, 0 ) == pdTRUE )
         {
-          gps_FrameDecoder();
+          if(gpsFirstByte == '$')  // Verifies the head of Frame
+          {
+            perfMon_Begin(gpsPerfId);
+            gps_FrameDecoder();
+            perfMon_End(gpsPerfId);
+          }
         }
+        xQueueReset(gpsRxQueue);
       }
-      if (false!=GpsData.bHealthRequest)  //Watchdog timer
+      if (0 != (u32Notify & GPS_NOTIFY_PPS))  // TIM3 stops in STOP mode
       {
-        WDTCheck_HealthResponse(WDT_CHECK_TASK_GPS_CODE);
-        GpsData.bHealthRequest = false;
+        if (ppsClock_IsPresent() != gpsPpsStopInhibit)
+        {
+          gpsPpsStopInhibit = ppsClock_IsPresent();
+          lowPower_StopInhibit(gpsPpsStopInhibit);
+        }
+      }
+      if (0 != (u32Notify & GPS_NOTIFY_HEALTH))  //Watchdog timer
+      {
+        WDTCheck_HealthResponse(gpsWdtId);
       }
-      xQueueReset(gpsRxQueue);
     }
   }
 }
@@ -110,7 +132,7 @@ void gps_Task(void * argument)
 
 void gps_ReceiveData(uint8_t pRxData)
 {
-  if (NULL==gpsTaskHandle || NULL == gpsSemaphoreHandle )
+  if (NULL==gpsTaskHandle || NULL == gpsRxQueue )
   {
     return;
   }
@@ -119,7 +141,7 @@ void gps_ReceiveData(uint8_t pRxData)
   xQueueSendFromISR(gpsRxQueue, &pRxData, NULL);
   if( (pRxData == '\n') || (xQueueIsQueueFullFromISR(gpsRxQueue) != pdFALSE))
   {
-    xSemaphoreGiveFromISR( gpsSemaphoreHandle, &xHigherPriorityTaskWoken );  //Semaphore signal
+    xTaskNotifyFromISR( gpsTaskHandle, GPS_NOTIFY_RX_LINE, eSetBits, &xHigherPriorityTaskWoken );
     portYIELD_FROM_ISR( xHigherPriorityTaskWoken );
   }
 }
@@ -210,6 +232,113 @@ uint32_t gps_GetValidDataAge(void)
 }
 
 
+// ppsClock_TicksToUtc() gives the UTC of the last fix to the microsecond
+uint32_t gps_GetFixTicks(void)
+{
+  return GpsData.u32FixTicks;
+}
+
+
+uint32_t gps_GetFixEpoch(void)
+{
+  return GpsData.u32FixEpoch;
+}
+
+
+/*
+ * Unix milliseconds: the last fix plus the RTOS tick since then, 0 before the
+ * first fix. A fix behind the tick estimate does not move it back. Not from
+ * ISRs, the tick has to be read with the anchor.
+ */
+uint64_t gps_GetTimeMs(void)
+{
+  uint64_t u64Ms = 0;
+
+  taskENTER_CRITICAL();
+  if (0 != GpsData.u32FixEpoch)
+  {
+    u64Ms = (uint64_t)GpsData.u32FixEpoch * 1000 +
+            (uint32_t)(xTaskGetTickCount() - GpsData.u32FixTick) * portTICK_PERIOD_MS;
+  }
+  if (u64Ms < gpsLastTimeMs)
+  {
+    u64Ms = gpsLastTimeMs;
+  }
+  gpsLastTimeMs = u64Ms;
+  taskEXIT_CRITICAL();
+  return u64Ms;
+}
+
+
+/*
+ * Days from civil on a year starting in March, so the leap day is the last
+ * one. The divisions are multiply and shift, exact for 1970..2106, the range of
+ * an unsigned 32 bit Unix time. The M0 has no divider.
+ */
+uint32_t gps_DateTimeToEpoch(const sGpsDateTime *pDateTime)
+{
+  uint32_t u32Carry = (pDateTime->sDate.u8Month <= 2) ? 1 : 0;       // January and February: previous year
+  uint32_t u32Year = pDateTime->sDate.u16Year - u32Carry;
+  uint32_t u32Month = pDateTime->sDate.u8Month + 12 * u32Carry - 3;  // 0 is March
+  uint32_t u32Days = 0;
+
+  u32Days = 365 * u32Year + (u32Year >> 2)
+            - (((u32Year >> 2) * 41) >> 10)                           // year / 100
+            + (((u32Year >> 4) * 41) >> 10)                           // year / 400
+            + (((153 * u32Month + 2) * 1639) >> 13)                   // (153 * month + 2) / 5
+            + pDateTime->sDate.u8Day - 1
+            - 719468;                                                 // 0000-03-01 to 1970-01-01
+  return u32Days * GPS_SEC_PER_DAY + (uint32_t)pDateTime->sTime.u8Hour * 3600 +
+         (uint32_t)pDateTime->sTime.u8Min * 60 + pDateTime->sTime.u8Sec;
+}
+
+
+/*
+ * Civil from days with 4 year cycles from 1968-03-01. 2100 is the only year of
+ * the range that breaks the cycle, its missing leap day is skipped.
+ */
+void gps_EpochToDateTime(uint32_t u32Epoch, sGpsDateTime *pDateTime)
+{
+  uint32_t u32Days = (uint32_t)(((uint64_t)(u32Epoch >> 7) * 50903317) >> 35);  // epoch / 86400
+  uint32_t u32Sec = u32Epoch - u32Days * GPS_SEC_PER_DAY;
+  uint32_t u32Cycle = 0;
+  uint32_t u32DayOfCycle = 0;
+  uint32_t u32YearOfCycle = 0;
+  uint32_t u32DayOfYear = 0;
+  uint32_t u32Month = 0;
+  uint32_t u32Hour = 0;
+
+  u32Hour = (u32Sec * 37283) >> 27;                                    // sec / 3600
+  u32Sec -= u32Hour * 3600;
+  pDateTime->sTime.u8Hour = u32Hour;
+  pDateTime->sTime.u8Min = (u32Sec * 2185) >> 17;                      // sec / 60
+  pDateTime->sTime.u8Sec = u32Sec - pDateTime->sTime.u8Min * 60;
+
+  u32Days += 671 + ((u32Days >= GPS_DAYS_2100_03_01) ? 1 : 0);          // 1968-03-01 to 1970-01-01
+  u32Cycle = (u32Days * 22967) >> 25;                                  // days / 1461
+  u32DayOfCycle = u32Days - u32Cycle * 1461;
+  u32YearOfCycle = ((u32DayOfCycle - ((u32DayOfCycle == 1460) ? 1 : 0)) * 1437) >> 19;  // / 365
+  u32DayOfYear = u32DayOfCycle - 365 * u32YearOfCycle;
+  u32Month = ((5 * u32DayOfYear + 2) * 857) >> 17;                     // (5 * day + 2) / 153, 0 is March
+  pDateTime->sDate.u8Day = u32DayOfYear - (((153 * u32Month + 2) * 1639) >> 13) + 1;
+  pDateTime->sDate.u8Month = (u32Month < 10) ? (u32Month + 3) : (u32Month - 9);
+  pDateTime->sDate.u16Year = 1968 + 4 * u32Cycle + u32YearOfCycle + ((u32Month >= 10) ? 1 : 0);
+}
+
+
+// GPS time has no leap seconds, GPS_LEAP_SECONDS has to follow the IERS bulletins
+uint32_t gps_EpochToGpsSeconds(uint32_t u32Epoch)
+{
+  return u32Epoch - GPS_EPOCH_UNIX_TO_GPS + GPS_LEAP_SECONDS;
+}
+
+
+uint32_t gps_GpsSecondsToEpoch(uint32_t u32GpsSeconds)
+{
+  return u32GpsSeconds + GPS_EPOCH_UNIX_TO_GPS - GPS_LEAP_SECONDS;
+}
+
+
 void gps_InitValidationParameters(void)
 {
   GpsValidationParameters.Hour.min = 0;
@@ -233,7 +362,7 @@ void gps_InitValidationParameters(void)
   GpsValidationParameters.Month.min = 1;
   GpsValidationParameters.Month.max = 12;
   GpsValidationParameters.Year.min = 1970;
-  GpsValidationParameters.Year.max = 2038;
+  GpsValidationParameters.Year.max = 2099;   // RMC has two digits, the epoch is unsigned
 }
 
 
@@ -243,6 +372,7 @@ void gps_FrameDecoder(void)
   uint8_t gpsRxSize = 0;
   uint8_t gpsRxIndex = 0;
   uint8_t gpsRxCurrentChar = 0;
+  uint8_t u8Frame = GPS_UNKNOWN_NMEA_FRAME;
   gpsRxSize = uxQueueMessagesWaiting(gpsRxQueue);
   if( gpsRxSize >= 3)
   {
@@ -255,18 +385,24 @@ void gps_FrameDecoder(void)
       gpsRxIndex++;
     }while(gpsRxIndex <= (gpsRxSize-2) );  // Copy from queue to local buffer
 
-    if( gps_VerifyChecksumNmea(gpsRxBuff) == true )
+    u8Frame = gps_FrameOfInterest(gpsRxBuff);  // 5 bytes, before the checksum of the whole line
+    if( (u8Frame != GPS_UNKNOWN_NMEA_FRAME) && (u8Frame != GPS_REDUNDANT_NMEA_FRAME) &&
+        (gps_VerifyChecksumNmea(gpsRxBuff) == true) )
     {
-      if(gps_FrameOfInterest(gpsRxBuff) == GPS_RMC_NMEA_FRAME_FOUND)
+      if(u8Frame == GPS_RMC_NMEA_FRAME_FOUND)
       {
         gps_ExtractDataRMC(gpsRxBuff);
         if ( gps_ValidationNMEAData() == true )
         {
           gps_UpdateGpsData();
+          GpsData.u32FixTicks = ppsClock_SetUtc(GpsDataRaw.u16Year, GpsDataRaw.u8Month, GpsDataRaw.u8Day,
+                                                (uint32_t)GpsDataRaw.u8Hour * 3600 +
+                                                (uint32_t)GpsDataRaw.u8Minute * 60 + GpsDataRaw.u8Second);
         }
       }
       else
       {
+        gps_ExtractDataGSV(gpsRxBuff);
       }
     }
   }
@@ -282,17 +418,68 @@ uint8_t *gps_GetNextToken(uint8_t * pData)
 }
 
 
+/*
+ * Sentences are routed by talker and type. A multi GNSS receiver sends the
+ * combined GN solution and may send the same fix per constellation too, the
+ * copies are dropped here, before their checksum, while a GN fix is recent.
+ */
 uint8_t gps_FrameOfInterest(uint8_t *pData)
 {
   uint8_t ucReturn = GPS_UNKNOWN_NMEA_FRAME;
-  if(  *(pData+2) && (*(pData+3) == 'M') && (*(pData+4) == 'C') )
+  eGpsTalker eTalker = gps_GetTalker(pData);
+
+  if( eTalker == GPS_TALKER_UNKNOWN )
+  {
+    return(ucReturn);
+  }
+  if( (*(pData+2) == 'R') && (*(pData+3) == 'M') && (*(pData+4) == 'C') )
   {
     ucReturn = GPS_RMC_NMEA_FRAME_FOUND;  // RMC frame found
+    if( (eTalker != GPS_TALKER_GNSS) && (gps_GnssFixIsRecent() == true) )
+    {
+      ucReturn = GPS_REDUNDANT_NMEA_FRAME;
+    }
+  }
+  else if( (*(pData+2) == 'G') && (*(pData+3) == 'S') && (*(pData+4) == 'V') &&
+           (eTalker < GPS_CONSTELLATIONS) )
+  {
+    ucReturn = GPS_GSV_NMEA_FRAME_FOUND;  // satellites in view of one constellation
   }
   return(ucReturn);
 }
 
 
+eGpsTalker gps_GetTalker(uint8_t *pData)
+{
+  eGpsTalker eTalker = GPS_TALKER_UNKNOWN;
+
+  if( *pData == 'G' )
+  {
+    switch( *(pData+1) )
+    {
+      case 'N': eTalker = GPS_TALKER_GNSS;    break;
+      case 'P': eTalker = GPS_TALKER_GPS;     break;
+      case 'L': eTalker = GPS_TALKER_GLONASS; break;
+      case 'A': eTalker = GPS_TALKER_GALILEO; break;
+      case 'B': eTalker = GPS_TALKER_BEIDOU;  break;  // NMEA 4.11
+      default: break;
+    }
+  }
+  else if( (*pData == 'B') && (*(pData+1) == 'D') )
+  {
+    eTalker = GPS_TALKER_BEIDOU;
+  }
+  return(eTalker);
+}
+
+
+bool gps_GnssFixIsRecent(void)
+{
+  return( (GpsData.u32FixEpoch != 0) && (GpsData.u8FixTalker == GPS_TALKER_GNSS) &&
+          ((xTaskGetTickCount() - GpsData.u32FixTick) < pdMS_TO_TICKS(GPS_GNSS_HOLD_MS)) );
+}
+
+
 bool gps_VerifyChecksumNmea(unsigned char * pData)
 {
   static uint8_t ucIndex;
@@ -346,10 +533,12 @@ bool gps_VerifyChecksumNmea(unsigned char * pData)
 }
 
 
+// Called once the checksum has passed, a corrupted line does not change the talker
 void gps_ExtractDataRMC(uint8_t *pframe)
 {
   uint8_t *pData = pframe;
 
+  GpsDataRaw.u8Talker = gps_GetTalker(pframe);
   pData = gps_GetNextToken(pData);
   gps_ExtractTime(pData);  // Extract HH:MM:SS
 
@@ -396,8 +585,85 @@ void gps_ExtractDataRMC(uint8_t *pframe)
 }
 
 
+/*
+ * A GSV group is 1..n messages of up to 4 satellites each. The counters add up
+ * while the messages come in order and reach the table with the last one; a
+ * lost message drops the group.
+ */
+void gps_ExtractDataGSV(uint8_t *pframe)
+{
+  uint8_t *pData = pframe;
+  eGpsTalker eTalker = gps_GetTalker(pframe);
+  volatile sGpsGsvGroup *pGroup = NULL;
+  uint8_t u8Msgs = 0;
+  uint8_t u8Msg = 0;
+  uint8_t u8Sats = 0;
+  uint8_t u8Snr = 0;
+
+  if( eTalker >= GPS_CONSTELLATIONS )
+  {
+    return;
+  }
+  pGroup = &GpsDataRaw.sGsv[eTalker];
+
+  pData = gps_GetNextToken(pData);
+  u8Msgs = gps_ExtractUint8(pData);
+  pData = gps_GetNextToken(pData);
+  u8Msg = gps_ExtractUint8(pData);
+  if( u8Msg == 1 )
+  {
+    pGroup->u8NextMsg = 1;
+    pGroup->u8Tracked = 0;
+    pGroup->u8SnrMax = 0;
+    pGroup->u16SnrSum = 0;
+  }
+  if( (u8Msg == 0) || (u8Msg > u8Msgs) || (u8Msg != pGroup->u8NextMsg) )
+  {
+    pGroup->u8NextMsg = 0;
+    return;
+  }
+
+  pData = gps_GetNextToken(pData);
+  pGroup->u8InView = gps_ExtractUint8(pData);
+  u8Sats = GPS_GSV_SATS_PER_MSG;
+  if( pGroup->u8InView < (u8Msg * GPS_GSV_SATS_PER_MSG) )  // last message of the group
+  {
+    u8Sats = pGroup->u8InView + GPS_GSV_SATS_PER_MSG - (u8Msg * GPS_GSV_SATS_PER_MSG);
+    u8Sats = (u8Sats > GPS_GSV_SATS_PER_MSG) ? 0 : u8Sats;
+  }
+  for( ; u8Sats > 0; u8Sats-- )
+  {
+    pData = gps_GetNextToken(pData);  // PRN
+    pData = gps_GetNextToken(pData);  // elevation
+    pData = gps_GetNextToken(pData);  // azimuth
+    pData = gps_GetNextToken(pData);  // SNR, empty when not tracked
+    if( (*pData >= '0') && (*pData <= '9') )
+    {
+      u8Snr = gps_ExtractUint8(pData);
+      pGroup->u8Tracked++;
+      pGroup->u16SnrSum += u8Snr;
+      pGroup->u8SnrMax = (u8Snr > pGroup->u8SnrMax) ? u8Snr : pGroup->u8SnrMax;
+    }
+  }
+
+  if( u8Msg < u8Msgs )
+  {
+    pGroup->u8NextMsg++;
+    return;
+  }
+  GpsData.sSatInfo.sConstellation[eTalker].u8InView = pGroup->u8InView;
+  GpsData.sSatInfo.sConstellation[eTalker].u8Tracked = pGroup->u8Tracked;
+  GpsData.sSatInfo.sConstellation[eTalker].u8SnrMax = pGroup->u8SnrMax;
+  GpsData.sSatInfo.sConstellation[eTalker].u8SnrAvg =
+      (pGroup->u8Tracked == 0) ? 0 : (pGroup->u16SnrSum / pGroup->u8Tracked);
+  pGroup->u8NextMsg = 0;
+}
+
+
 bool gps_ValidationNMEAData(void)
 {
+  sGpsDateTime sDateTime;
+
   if( (GpsDataRaw.cStatus != GpsValidationParameters.Status.min) )
   {
     return false;
@@ -421,6 +687,17 @@ bool gps_ValidationNMEAData(void)
   {
     return false;
   }
+  sDateTime.sDate.u16Year = GpsDataRaw.u16Year;
+  sDateTime.sDate.u8Month = GpsDataRaw.u8Month;
+  sDateTime.sDate.u8Day = GpsDataRaw.u8Day;
+  sDateTime.sTime.u8Hour = GpsDataRaw.u8Hour;
+  sDateTime.sTime.u8Min = GpsDataRaw.u8Minute;
+  sDateTime.sTime.u8Sec = GpsDataRaw.u8Second;
+  GpsDataRaw.u32Epoch = gps_DateTimeToEpoch(&sDateTime);
+  if (gps_TimeInWindow(GpsDataRaw.u32Epoch) == false)
+  {
+    return false;
+  }
   if( ((GpsDataRaw.sLatitude.i16Degrees >= GpsValidationParameters.Latitude.min ) &&
        (GpsDataRaw.sLatitude.i16Degrees <= GpsValidationParameters.Latitude.max) &&
        (GpsDataRaw.sLatitude.cOrientation == 'N' || GpsDataRaw.sLatitude.cOrientation == 'S') ) == false )
@@ -437,6 +714,48 @@ bool gps_ValidationNMEAData(void)
 }
 
 
+// The next fix is not compared with the last one (time window, GN preference)
+void gps_ResetFixHistory(void)
+{
+  taskENTER_CRITICAL();
+  GpsData.u32FixEpoch = 0;
+  GpsData.u8TimeRejects = 0;
+  taskEXIT_CRITICAL();
+}
+
+
+/*
+ * The fix time may not go back nor run ahead of the RTOS tick since the last
+ * fix. A receiver whose time really jumped is followed after
+ * GPS_TIME_WINDOW_REJECTS fixes.
+ */
+bool gps_TimeInWindow(uint32_t u32Epoch)
+{
+  uint32_t u32ElapsedMs = 0;
+
+  if (0 == GpsData.u32FixEpoch)
+  {
+    return true;
+  }
+  // Compared in ms: no division on the M0, and no second lost to the truncation
+  u32ElapsedMs = (xTaskGetTickCount() - GpsData.u32FixTick) * portTICK_PERIOD_MS;
+  if ((u32Epoch >= GpsData.u32FixEpoch) &&
+      (((uint64_t)(u32Epoch - GpsData.u32FixEpoch) * 1000) <=
+       ((uint64_t)u32ElapsedMs + (u32ElapsedMs >> 5) + (GPS_TIME_WINDOW_S * 1000))))
+  {
+    GpsData.u8TimeRejects = 0;
+    return true;
+  }
+  GpsData.u8TimeRejects++;
+  if (GpsData.u8TimeRejects >= GPS_TIME_WINDOW_REJECTS)
+  {
+    GpsData.u8TimeRejects = 0;
+    return true;
+  }
+  return false;
+}
+
+
 void gps_UpdateGpsData(void)
 {
   // Valid frame
@@ -453,6 +772,11 @@ void gps_UpdateGpsData(void)
   GpsData.sDateTime.sTime.u8Hour = GpsDataRaw.u8Hour;
   GpsData.sDateTime.sTime.u8Min = GpsDataRaw.u8Minute;
   GpsData.sDateTime.sTime.u8Sec = GpsDataRaw.u8Second;
+  taskENTER_CRITICAL();   // anchor of gps_GetTimeMs
+  GpsData.u32FixEpoch = GpsDataRaw.u32Epoch;
+  GpsData.u8FixTalker = GpsDataRaw.u8Talker;
+  GpsData.u32FixTick = xTaskGetTickCount();
+  taskEXIT_CRITICAL();
 
   // position
   GpsData.sPos.sLatitude = GpsDataRaw.sLatitude;
@@ -461,32 +785,73 @@ void gps_UpdateGpsData(void)
 }
 
 
+// EXTI of the PPS pin
 void gps_PPSReceived(void)
 {
+  portBASE_TYPE xHigherPriorityTaskWoken = pdFALSE;
   GpsData.u32ValidDataAge +=1;
   if (GpsData.u32ValidDataAge > 1)
   {
     GpsData.bValidFrame = false;
   }
+  if ((true == ppsClock_Edge()) && (NULL != gpsTaskHandle))
+  {
+    xTaskNotifyFromISR(gpsTaskHandle, GPS_NOTIFY_PPS, eSetBits, &xHigherPriorityTaskWoken);
+    portYIELD_FROM_ISR(xHigherPriorityTaskWoken);
+  }
 }
 
 
+// TIM3 overflow, once per PPS_CLOCK_TIMEOUT_US without PPS edge
 void gps_NoPPSReceived(void)
 {
+  portBASE_TYPE xHigherPriorityTaskWoken = pdFALSE;
   GpsData.u32ValidDataAge +=1;
   GpsData.bValidFrame = false;
-  if (NULL!=TIMER_INSTANCE)
+  if ((true == gpsPpsStopInhibit) && (NULL != gpsTaskHandle))
   {
-    __HAL_TIM_SET_COUNTER(TIMER, 0);
-    __HAL_TIM_SET_AUTORELOAD(TIMER, GPS_TIMER_1_SEG);
+    xTaskNotifyFromISR(gpsTaskHandle, GPS_NOTIFY_PPS, eSetBits, &xHigherPriorityTaskWoken);
+    portYIELD_FROM_ISR(xHigherPriorityTaskWoken);
   }
-
 }
 
 
 void gps_HealthRequest(void)
 {
-  GpsData.bHealthRequest = true;
+  if (NULL==gpsTaskHandle)
+  {
+    return;
+  }
+  xTaskNotify(gpsTaskHandle, GPS_NOTIFY_HEALTH, eSetBits);
+}
+
+
+sGpsConstellation gps_GetConstellation(eGpsTalker eTalker)
+{
+  sGpsConstellation sConstellation = {0, 0, 0, 0};
+  if (eTalker < GPS_CONSTELLATIONS)
+  {
+    sConstellation = GpsData.sSatInfo.sConstellation[eTalker];
+  }
+  return sConstellation;
+}
+
+
+void gps_PrintSatellites(void)
+{
+  static const char * const acName[GPS_CONSTELLATIONS] = {"GPS", "GLONASS", "Galileo", "BeiDou"};
+  sGpsConstellation sConstellation;
+
+  printf("%s> fix from %s\r\n", GPS_PROMPT,
+         (GpsData.u32FixEpoch == 0) ? "none" :
+         (GpsData.u8FixTalker == GPS_TALKER_GNSS) ? "GN (combined)" : acName[GpsData.u8FixTalker]);
+  for (uint8_t u8Id = 0; u8Id < GPS_CONSTELLATIONS; u8Id++)
+  {
+    sConstellation = gps_GetConstellation((eGpsTalker)u8Id);
+    printf("%s> %-8s in view:%2u tracked:%2u SNR max:%2u avg:%2u\r\n", GPS_PROMPT, acName[u8Id],
+           sConstellation.u8InView, sConstellation.u8Tracked, sConstellation.u8SnrMax,
+           sConstellation.u8SnrAvg);
+  }
 }
 
 
@@ -504,6 +869,20 @@ void gps_ExtractTime(uint8_t *pData)
 }
 
 
+// Decimal field, stops on the first character that is not a digit
+uint8_t gps_ExtractUint8(uint8_t *pData)
+{
+  uint8_t u8Value = 0;
+  uint8_t u8Len = 0;
+  while( (u8Len < 3) && (*(pData + u8Len) >= '0') && (*(pData + u8Len) <= '9') )
+  {
+    u8Value = (u8Value * 10) + (*(pData + u8Len) - 0x30);
+    u8Len++;
+  }
+  return(u8Value);
+}
+
+
 void gps_ExtractDate(uint8_t *pData)
 {
   //Yearh
@@ -0,0 +1,365 @@
+/*******************************************************************************
+* Filename: lowPower.c
+* Developer: Jorge Yesid Rios Ortiz
+*******************************************************************************/
+
+#include <stdio.h>
+#include <inttypes.h>
+#include "lowPower.h"
+#include "main.h"
+#include "cmsis_os.h"
+#include "perfMon.h"
+
+/*
+ * Tickless idle on STOP mode. SysTick, TIM1 (HAL tick) and the PLL stop, so
+ * the elapsed time is read back from the RTC running on LSI: PREDIV_A 39
+ * gives a 1kHz subsecond counter, the same rate as the kernel tick. LSI is
+ * only +-25% accurate, so one RTC tick is measured against TIM6 (HSI based)
+ * before STOP is allowed. The RTC wakeup timer (RTCCLK/16) ends the sleep at
+ * the next kernel timeout; USART1/USART3 (start bit) and the PPS EXTI line
+ * wake the core earlier.
+ * TIM2 (LD2) stops as well: it registers as a timer, STOP ends before its
+ * next toggle and its counter is moved on by the time slept. The PLL is
+ * restarted with the interrupts enabled (the scheduler is suspended), so
+ * USART3 at 230400 baud, one byte every 43us, is served during the relock
+ * instead of overrunning. The restart is done on the registers: the HAL tick
+ * is suspended, so the timeouts of HAL_RCC_OscConfig would never expire.
+ */
+
+#define LOW_POWER_WUT_PER_RTC_TICK_X2   5      // (PREDIV_A+1)/16 = 2.5 wakeup counts per RTC tick
+#define LOW_POWER_RTC_DAY_TICKS         86400000UL
+
+#define LOW_POWER_RTC_UNLOCK()          do { RTC->WPR = 0xCA; RTC->WPR = 0x53; } while(0)
+#define LOW_POWER_RTC_LOCK()            (RTC->WPR = 0xFF)
+#define LOW_POWER_RTC_CLEAR_WUTF()      (RTC->ISR = (~(RTC_ISR_WUTF | RTC_ISR_INIT)) | (RTC->ISR & RTC_ISR_INIT))
+#define LOW_POWER_RTC_CLEAR_RSF()       (RTC->ISR = (~(RTC_ISR_RSF | RTC_ISR_INIT)) | (RTC->ISR & RTC_ISR_INIT))
+
+sLowPower LowPower;
+
+uint32_t lowPower_RtcTicks(void);
+void lowPower_RtcInit(void);
+void lowPower_RtcResync(void);
+void lowPower_PllRestart(void);
+
+
+void lowPower_Init(void)
+{
+  LowPower.u8StopInhibit = 1;  // released by lowPower_Calibrate()
+  LowPower.bCalibrated = false;
+  LowPower.u32UsPerRtcTick = LOW_POWER_RTC_NOMINAL_US;
+  LowPower.u32StopCount = 0;
+  LowPower.u32StopMs = 0;
+  LowPower.u32WakeByTimer = 0;
+  LowPower.u32RsfTimeouts = 0;
+  LowPower.u32PllTimeouts = 0;
+  lowPower_RtcInit();
+}
+
+
+void lowPower_RtcInit(void)
+{
+  __HAL_RCC_PWR_CLK_ENABLE();
+  HAL_PWR_EnableBkUpAccess();
+  if ((RCC->BDCR & RCC_BDCR_RTCSEL) != RCC_BDCR_RTCSEL_LSI)
+  {
+    RCC->BDCR |= RCC_BDCR_BDRST;
+    RCC->BDCR &= ~RCC_BDCR_BDRST;
+    RCC->BDCR |= RCC_BDCR_RTCSEL_LSI;
+  }
+  RCC->BDCR |= RCC_BDCR_RTCEN;
+
+  LOW_POWER_RTC_UNLOCK();
+  RTC->ISR |= RTC_ISR_INIT;
+  while (0 == (RTC->ISR & RTC_ISR_INITF));
+  RTC->PRER = (39 << RTC_PRER_PREDIV_A_Pos) | (999 << RTC_PRER_PREDIV_S_Pos);
+  RTC->TR = 0;
+  RTC->ISR &= ~RTC_ISR_INIT;
+
+  RTC->CR &= ~(RTC_CR_WUTE | RTC_CR_WUTIE);
+  while (0 == (RTC->ISR & RTC_ISR_WUTWF));
+  RTC->CR = (RTC->CR & ~RTC_CR_WUCKSEL) | 0;  // RTCCLK/16
+  LOW_POWER_RTC_LOCK();
+
+  EXTI->IMR |= EXTI_IMR_MR20;    // RTC wakeup timer line
+  EXTI->RTSR |= EXTI_RTSR_RT20;
+  HAL_NVIC_SetPriority(RTC_IRQn, 3, 0);
+  HAL_NVIC_EnableIRQ(RTC_IRQn);
+}
+
+
+/*
+ * Milliseconds of the day in RTC ticks. Reading SSR freezes TR until DR is
+ * read, so the three registers are consistent.
+ */
+uint32_t lowPower_RtcTicks(void)
+{
+  uint32_t u32Ssr = RTC->SSR;
+  uint32_t u32Tr = RTC->TR;
+  (void)RTC->DR;
+  uint32_t u32Sec = ((u32Tr >> 20) & 0x3) * 10 + ((u32Tr >> 16) & 0xF);
+  u32Sec = u32Sec * 60 + ((u32Tr >> 12) & 0x7) * 10 + ((u32Tr >> 8) & 0xF);
+  u32Sec = u32Sec * 60 + ((u32Tr >> 4) & 0x7) * 10 + (u32Tr & 0xF);
+  return u32Sec * 1000 + (999 - u32Ssr);
+}
+
+
+/*
+ * The shadow registers keep the time of the STOP entry until the next RTCCLK
+ * synchronisation: RSF is cleared and awaited before TR/SSR are read again.
+ * It runs with the interrupts masked, the wait is bounded by loops instead of
+ * the HAL tick.
+ */
+void lowPower_RtcResync(void)
+{
+  uint32_t u32Loops = 0;
+
+  LOW_POWER_RTC_UNLOCK();
+  LOW_POWER_RTC_CLEAR_RSF();
+  LOW_POWER_RTC_LOCK();
+  while (0 == (RTC->ISR & RTC_ISR_RSF))
+  {
+    if (LOW_POWER_RSF_WAIT_LOOPS <= ++u32Loops)
+    {
+      LowPower.u32RsfTimeouts++;   // the read may be one RTC tick old
+      return;
+    }
+  }
+}
+
+
+/*
+ * Back from HSI to the 48MHz PLL. STOP clears PLLON and SW only: the PLL
+ * source, multiplier and divider and the flash latency of
+ * SystemClock_Config() are still set, HAL_InitTick and the UART clock
+ * selection need not run again. The waits are bounded by loops like the RSF
+ * one.
+ */
+void lowPower_PllRestart(void)
+{
+  uint32_t u32Loops = 0;
+
+  RCC->CR |= RCC_CR_PLLON;
+  while (0 == (RCC->CR & RCC_CR_PLLRDY))
+  {
+    if (LOW_POWER_PLL_WAIT_LOOPS <= ++u32Loops)
+    {
+      LowPower.u32PllTimeouts++;   // stays on HSI, the next wake tries again
+      return;
+    }
+  }
+  RCC->CFGR = (RCC->CFGR & ~RCC_CFGR_SW) | RCC_CFGR_SW_PLL;
+  u32Loops = 0;
+  while (RCC_CFGR_SWS_PLL != (RCC->CFGR & RCC_CFGR_SWS))
+  {
+    if (LOW_POWER_PLL_WAIT_LOOPS <= ++u32Loops)
+    {
+      LowPower.u32PllTimeouts++;
+      return;
+    }
+  }
+}
+
+
+/*
+ * RTC ticks to kernel ticks with the measured RTC tick length. Kept apart
+ * from the sleep path so the compensation math can be checked on its own.
+ */
+uint32_t lowPower_TicksFromRtc(uint32_t u32RtcTicks, uint32_t u32UsPerRtcTick)
+{
+  // u32RtcTicks <= LOW_POWER_MAX_IDLE_MS * 1.3, the product stays in 32 bits
+  return (u32RtcTicks * u32UsPerRtcTick) / (1000000UL / configTICK_RATE_HZ);
+}
+
+
+/*
+ * Measures one RTC subsecond tick against TIM6. Blocks the calling task for
+ * LOW_POWER_CAL_TIME_MS and releases the initial STOP inhibit.
+ */
+void lowPower_Calibrate(void)
+{
+  uint32_t u32Rtc0 = 0;
+  uint32_t u32Rtc1 = 0;
+  uint32_t u32Us0 = 0;
+  uint32_t u32Us1 = 0;
+
+  u32Rtc0 = lowPower_RtcTicks();
+  while (u32Rtc0 == lowPower_RtcTicks());  // align on a tick edge
+  u32Us0 = perfMon_GetUs();
+  u32Rtc0 = lowPower_RtcTicks();
+  vTaskDelay(LOW_POWER_CAL_TIME_MS);
+  u32Rtc1 = lowPower_RtcTicks();
+  while (u32Rtc1 == lowPower_RtcTicks());
+  u32Us1 = perfMon_GetUs();
+  u32Rtc1 = lowPower_RtcTicks();
+
+  u32Rtc1 = (u32Rtc1 + LOW_POWER_RTC_DAY_TICKS - u32Rtc0) % LOW_POWER_RTC_DAY_TICKS;
+  if (0 != u32Rtc1)
+  {
+    LowPower.u32UsPerRtcTick = (u32Us1 - u32Us0) / u32Rtc1;
+  }
+  if (false == LowPower.bCalibrated)
+  {
+    LowPower.bCalibrated = true;
+    lowPower_StopInhibit(false);
+  }
+}
+
+
+void lowPower_StopInhibit(bool bInhibit)
+{
+  taskENTER_CRITICAL();
+  if (true == bInhibit)
+  {
+    LowPower.u8StopInhibit++;
+  }
+  else if (0 < LowPower.u8StopInhibit)
+  {
+    LowPower.u8StopInhibit--;
+  }
+  taskEXIT_CRITICAL();
+}
+
+
+/*
+ * Adds a timer that stops in STOP mode. Must be called before the scheduler
+ * starts. pfMsToEvent caps the sleep, pfAdvance gets the kernel ticks slept.
+ */
+bool lowPower_RegisterTimer(pfLowPowerMsToEvent pfMsToEvent, pfLowPowerAdvance pfAdvance)
+{
+  if ((NULL == pfMsToEvent) || (NULL == pfAdvance) || (LOW_POWER_MAX_TIMERS <= LowPower.u8Timers))
+  {
+    return false;
+  }
+  LowPower.pfMsToEvent[LowPower.u8Timers] = pfMsToEvent;
+  LowPower.pfAdvance[LowPower.u8Timers] = pfAdvance;
+  LowPower.u8Timers++;
+  return true;
+}
+
+
+// Longest STOP period for the kernel idle time: WUTR range and the next timer event
+uint32_t lowPower_IdleLimit(uint32_t u32ExpectedIdleTime)
+{
+  uint32_t u32Ms = 0;
+
+  if (u32ExpectedIdleTime > LOW_POWER_MAX_IDLE_MS)
+  {
+    u32ExpectedIdleTime = LOW_POWER_MAX_IDLE_MS;
+  }
+  for (uint8_t u8Timer = 0; u8Timer < LowPower.u8Timers; u8Timer++)
+  {
+    u32Ms = LowPower.pfMsToEvent[u8Timer]();
+    if (u32Ms < u32ExpectedIdleTime)
+    {
+      u32ExpectedIdleTime = u32Ms;
+    }
+  }
+  return u32ExpectedIdleTime;
+}
+
+
+/*
+ * portSUPPRESS_TICKS_AND_SLEEP, called by the idle task with the scheduler
+ * suspended.
+ */
+void lowPower_SuppressTicksAndSleep(uint32_t u32ExpectedIdleTime)
+{
+  uint32_t u32RtcStart = 0;
+  uint32_t u32Elapsed = 0;
+  uint32_t u32Wut = 0;
+  bool bWakeByTimer = false;
+
+  __disable_irq();
+  if (eTaskConfirmSleepModeStatus() == eAbortSleep)
+  {
+    __enable_irq();
+    return;
+  }
+  u32ExpectedIdleTime = lowPower_IdleLimit(u32ExpectedIdleTime);
+  if ((0 != LowPower.u8StopInhibit) || (configEXPECTED_IDLE_TIME_BEFORE_SLEEP > u32ExpectedIdleTime))
+  {
+    // SLEEP with the tick running: timers and the LED keep going
+    __DSB();
+    __WFI();
+    __ISB();
+    __enable_irq();
+    return;
+  }
+
+  SysTick->CTRL &= ~SysTick_CTRL_ENABLE_Msk;
+  HAL_SuspendTick();
+
+  u32Wut = (u32ExpectedIdleTime * 1000 / LowPower.u32UsPerRtcTick) * LOW_POWER_WUT_PER_RTC_TICK_X2 / 2;
+  LOW_POWER_RTC_UNLOCK();
+  RTC->CR &= ~RTC_CR_WUTE;
+  while (0 == (RTC->ISR & RTC_ISR_WUTWF));
+  RTC->WUTR = (0 < u32Wut) ? (u32Wut - 1) : 0;
+  LOW_POWER_RTC_CLEAR_WUTF();
+  RTC->CR |= RTC_CR_WUTE | RTC_CR_WUTIE;
+  LOW_POWER_RTC_LOCK();
+  u32RtcStart = lowPower_RtcTicks();
+
+  HAL_PWR_EnterSTOPMode(PWR_LOWPOWERREGULATOR_ON, PWR_STOPENTRY_WFI);
+
+  // Before the wakeup interrupt clears it
+  bWakeByTimer = (0 != (RTC->ISR & RTC_ISR_WUTF));
+
+  // The pending wakeup interrupt runs first, the UARTs (HSI clocked) keep being served during the relock
+  __enable_irq();
+  lowPower_PllRestart();
+  __disable_irq();
+
+  lowPower_RtcResync();
+  u32Elapsed = (lowPower_RtcTicks() + LOW_POWER_RTC_DAY_TICKS - u32RtcStart) % LOW_POWER_RTC_DAY_TICKS;
+  u32Elapsed = lowPower_TicksFromRtc(u32Elapsed, LowPower.u32UsPerRtcTick);
+
+  LOW_POWER_RTC_UNLOCK();
+  RTC->CR &= ~(RTC_CR_WUTE | RTC_CR_WUTIE);
+  LOW_POWER_RTC_LOCK();
+  if (true == bWakeByTimer)
+  {
+    LowPower.u32WakeByTimer++;
+  }
+
+  // the tick that is about to run counts for the last period
+  if (u32Elapsed >= u32ExpectedIdleTime)
+  {
+    u32Elapsed = u32ExpectedIdleTime - 1;
+  }
+  if (0 < u32Elapsed)
+  {
+    vTaskStepTick(u32Elapsed);
+    for (uint8_t u8Timer = 0; u8Timer < LowPower.u8Timers; u8Timer++)
+    {
+      LowPower.pfAdvance[u8Timer](u32Elapsed);
+    }
+  }
+  LowPower.u32StopCount++;
+  LowPower.u32StopMs += u32Elapsed;
+
+  SysTick->VAL = 0;
+  SysTick->CTRL |= SysTick_CTRL_ENABLE_Msk;
+  HAL_ResumeTick();
+  __enable_irq();
+}
+
+
+void lowPower_RtcWakeup(void)
+{
+  LOW_POWER_RTC_UNLOCK();
+  LOW_POWER_RTC_CLEAR_WUTF();
+  LOW_POWER_RTC_LOCK();
+  EXTI->PR = EXTI_PR_PR20;
+}
+
+
+void lowPower_Print(void)
+{
+  uint32_t u32Uptime = xTaskGetTickCount();
+  printf("%s> stop:%" PRIu32 " wakeByTimer:%" PRIu32 " stopMs:%" PRIu32 " uptimeMs:%" PRIu32 " duty:%" PRIu32
+         "%% rtcTick:%" PRIu32 "us inhibit:%u rsfTimeouts:%" PRIu32 " pllTimeouts:%" PRIu32 "\r\n",
+         LOW_POWER_PROMPT, LowPower.u32StopCount, LowPower.u32WakeByTimer, LowPower.u32StopMs, u32Uptime,
+         (100 <= u32Uptime) ? (100 - (LowPower.u32StopMs / (u32Uptime / 100))) : 100,
+         LowPower.u32UsPerRtcTick, LowPower.u8StopInhibit, LowPower.u32RsfTimeouts,
+         LowPower.u32PllTimeouts);
+}
@@ -20,6 +20,7 @@
 #include "main.h"
 #include "cmsis_os.h"
 #include "iwdg.h"
+#include "tim.h"
 #include "usart.h"
 #include "gpio.h"
 
@@ -31,6 +32,10 @@
 #include "retarget.h"
 #include "shell.h"
 #include "checkPosition.h"
+#include "perfMon.h"
+#include "lowPower.h"
+#include "bench.h"
+#include "ppsClock.h"
 /* USER CODE END Includes */
 
 /* Private typedef -----------------------------------------------------------*/
@@ -96,7 +101,14 @@ int main(void)
   MX_USART1_UART_Init();
   //MX_IWDG_Init();
   MX_USART3_UART_Init();
+  MX_TIM2_Init();
+  MX_TIM3_Init();
+  MX_TIM6_Init();
   /* USER CODE BEGIN 2 */
+  perfMon_Init();
+  lowPower_Init();
+  ppsClock_Init();
+  bench_Init();
 
   gps_InitFw();
   WDTCheck_InitFW();
@@ -108,35 +120,6 @@ int main(void)
   printf("* GPS FIRMWARE TEST *\r\n");
   printf("*********************\r\n");
 
-/*
-  double dLatitudeDDM  = 0;
-  double dLongitudeDDM = 0;
-  double difLatitude   = 0;
-  double difLongitude =  0;
-  sCheckPosApp sCheckPos;
-  sCheckPos.dLatitude = 4.752554848;
-  sCheckPos.dLongitude= -74.08948412;
-  sCheckPos.dEarthRad = 6378.1;
-  while(1)
-  {
-    dLatitudeDDM  =  4.754917;
-    dLongitudeDDM = -74.09110;
-    difLatitude =  (dLatitudeDDM  - sCheckPos.dLatitude)   *M_PI/180;
-    difLongitude = (dLongitudeDDM - sCheckPos.dLongitude)  *M_PI/180;
-
-    //printf("[%s] lat:%f lon:%f ", CHECK_POS_PROMPT, dLatitudeDDM, dLongitudeDDM);
-    dLatitudeDDM  *= M_PI/180;
-    dLongitudeDDM *= M_PI/180;
-    sCheckPos.dDistance = pow(sin(difLatitude / 2), 2) +
-                          pow(sin(difLongitude / 2), 2) * cos(dLatitudeDDM*M_PI/180) * cos(sCheckPos.dLatitude*M_PI/180);
-    sCheckPos.dDistance = 2 * sCheckPos.dEarthRad * asin(sqrt(sCheckPos.dDistance))*1000;
-    printf("sCheckPos.dDistance = %f\r\n", sCheckPos.dDistance);
-    //printf(" Distance:%f%s\r\n", sCheckPos.dDistance, (sCheckPos.dDistance<=100?" close to taget!":""));
-  }
-
-  */
-
-
   /* USER CODE END 2 */
 
   /* Call init function for freertos objects (in freertos.c) */
@@ -194,8 +177,8 @@ void SystemClock_Config(void)
     Error_Handler();
   }
   PeriphClkInit.PeriphClockSelection = RCC_PERIPHCLK_USART3|RCC_PERIPHCLK_USART1;
-  PeriphClkInit.Usart1ClockSelection = RCC_USART1CLKSOURCE_PCLK1;
-  PeriphClkInit.Usart3ClockSelection = RCC_USART3CLKSOURCE_PCLK1;
+  PeriphClkInit.Usart1ClockSelection = RCC_USART1CLKSOURCE_HSI;
+  PeriphClkInit.Usart3ClockSelection = RCC_USART3CLKSOURCE_HSI;
   if (HAL_RCCEx_PeriphCLKConfig(&PeriphClkInit) != HAL_OK)
   {
     Error_Handler();
@@ -223,6 +206,17 @@ void HAL_TIM_PeriodElapsedCallback(TIM_HandleTypeDef *htim)
     HAL_IncTick();
   }
   /* USER CODE BEGIN Callback 1 */
+  if (htim->Instance == TIM2) {
+    WDTCheck_LedPeriodElapsed();
+  }
+  if (htim->Instance == TIM3) {
+    if (true == ppsClock_TimerOverflow()) {
+      gps_NoPPSReceived();
+    }
+  }
+  if (htim->Instance == TIM6) {
+    perfMon_TimerOverflow();
+  }
 
   /* USER CODE END Callback 1 */
 }
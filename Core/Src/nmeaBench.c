@@ -0,0 +1,195 @@
+/*******************************************************************************
+* Filename: nmeaBench.c
+* Developer: Jorge Yesid Rios Ortiz
+*******************************************************************************/
+
+#include <inttypes.h>
+#include <stdio.h>
+#include <string.h>
+#include "nmeaBench.h"
+#include "gps.h"
+#include "perfMon.h"
+#include "cmsis_os.h"
+
+/*
+ * Replays a recorded NMEA corpus through the same stages gps_FrameDecoder runs
+ * and times every stage with the TIM6 microsecond clock. The scheduler is
+ * suspended during the run so the gps task never sees the replayed sentences
+ * and the static state of the checksum routine is not shared. The live gps
+ * snapshot is saved before the run and restored after it.
+ *
+ * Lines are stored as the decoder sees them: without '$' and without "\r\n".
+ * An empty line starts the log of another receiver, the fix history is reset.
+ */
+
+#define NMEA_BENCH_NEW_RECEIVER   ""
+
+extern sGpsData GpsData;
+extern sGpsDataFromGps GpsDataRaw;
+
+static const char * const NmeaBenchCorpus[] =
+{
+  // single constellation, 1 Hz
+  "GPRMC,123519,A,4807.038,N,01131.000,E,022.4,084.4,230394,003.1,W*6A",
+  "GPGGA,123519,4807.038,N,01131.000,E,1,08,0.9,545.4,M,46.9,M,,*47",
+  NMEA_BENCH_NEW_RECEIVER,
+  // multi GNSS receiver
+  "GNRMC,101530.00,A,0445.15264,N,07405.46637,W,0.021,,190622,,,A*70",
+  "GPRMC,101530.00,A,0445.15264,N,07405.46637,W,0.021,,190622,,,A*6E",  // copies of the GN fix
+  "GLRMC,101530.00,A,0445.15264,N,07405.46637,W,0.021,,190622,,,A*72",
+  "GNGGA,101530.00,0445.15264,N,07405.46637,W,1,12,0.71,2561.3,M,3.4,M,,*50",
+  "GNGSA,A,3,05,13,15,18,20,24,29,,,,,,1.32,0.71,1.11*1E",
+  "GPGSV,3,1,11,05,43,186,38,13,25,315,31,15,67,012,42,18,33,118,36*79",
+  "GLGSV,2,1,07,66,42,063,30,67,61,320,35,68,17,278,24,76,22,036,28*6D",
+  "GLGSV,2,2,07,77,48,151,33,78,12,205,,86,30,290,22*56",
+  "GAGSV,1,1,04,03,32,131,33,05,47,245,37,09,18,052,25,24,56,289,40*6E",
+  "BDGSV,1,1,03,11,52,300,33,12,20,190,27,34,41,060,31*55",
+  // 10 Hz burst
+  "GNRMC,101530.10,A,0445.15265,N,07405.46638,W,0.018,,190622,,,A*75",
+  "GNRMC,101530.20,A,0445.15265,N,07405.46639,W,0.025,,190622,,,A*79",
+  "GNRMC,101530.30,A,0445.15266,N,07405.46639,W,0.020,,190622,,,A*7E",
+  // no fix
+  "GPRMC,101531.00,V,,,,,,,190622,,,N*74",
+  // corrupted
+  "GNRMC,101530.40,A,0445.15266,N,07405.46640,W,0.020,,190622,,,A*71",  // wrong checksum
+  "GNRMC,101530.50,A,0445.1",                                            // truncated
+  "GPGGA,1015\x13\xff" "0,04,,N*2",                                      // line noise
+};
+
+#define NMEA_BENCH_CORPUS_SIZE   (sizeof(NmeaBenchCorpus) / sizeof(NmeaBenchCorpus[0]))
+
+static const char * const NmeaBenchStageName[NMEA_BENCH_STAGES] =
+{
+  "filter",
+  "checksum",
+  "extract",
+  "validate",
+  "update",
+};
+
+uint32_t nmeaBench_Stage(sNmeaBenchResult *pResult, eNmeaBenchStage eStage, uint32_t u32StartUs);
+
+
+void nmeaBench_Run(uint8_t u8Passes, sNmeaBenchResult *pResult)
+{
+  uint8_t au8Line[GPS_RX_QUEUE_SIZE];
+  sGpsData sSavedData;
+  sGpsDataFromGps sSavedRaw;
+  uint32_t u32StartUs = 0;
+  uint32_t u32RunUs = 0;
+  size_t xLen = 0;
+  uint8_t u8Frame = GPS_UNKNOWN_NMEA_FRAME;
+
+  memset(pResult, 0, sizeof(sNmeaBenchResult));
+
+  vTaskSuspendAll();
+  memcpy(&sSavedData, (void *)&GpsData, sizeof(sGpsData));
+  memcpy(&sSavedRaw, (void *)&GpsDataRaw, sizeof(sGpsDataFromGps));
+
+  u32RunUs = perfMon_GetUs();
+  for (uint8_t u8Pass = 0; u8Pass < u8Passes; u8Pass++)
+  {
+    gps_ResetFixHistory();     // the corpus goes back in time on every pass
+    for (uint8_t u8Line = 0; u8Line < NMEA_BENCH_CORPUS_SIZE; u8Line++)
+    {
+      xLen = strlen(NmeaBenchCorpus[u8Line]);
+      if (0 == xLen)
+      {
+        gps_ResetFixHistory();
+        continue;
+      }
+      memset(au8Line, 0, sizeof(au8Line));
+      memcpy(au8Line, NmeaBenchCorpus[u8Line], xLen);
+      pResult->u32Sentences++;
+      pResult->u32Bytes += xLen + 3;   // '$' and "\r\n" on the wire
+
+      u32StartUs = perfMon_GetUs();
+      u8Frame = gps_FrameOfInterest(au8Line);
+      if ((GPS_UNKNOWN_NMEA_FRAME == u8Frame) || (GPS_REDUNDANT_NMEA_FRAME == u8Frame))
+      {
+        nmeaBench_Stage(pResult, NMEA_BENCH_STAGE_FILTER, u32StartUs);
+        pResult->u32Skipped++;
+        continue;
+      }
+      u32StartUs = nmeaBench_Stage(pResult, NMEA_BENCH_STAGE_FILTER, u32StartUs);
+
+      if (gps_VerifyChecksumNmea(au8Line) == false)
+      {
+        nmeaBench_Stage(pResult, NMEA_BENCH_STAGE_CHECKSUM, u32StartUs);
+        pResult->u32Rejected++;
+        continue;
+      }
+      u32StartUs = nmeaBench_Stage(pResult, NMEA_BENCH_STAGE_CHECKSUM, u32StartUs);
+
+      if (GPS_GSV_NMEA_FRAME_FOUND == u8Frame)
+      {
+        gps_ExtractDataGSV(au8Line);
+        nmeaBench_Stage(pResult, NMEA_BENCH_STAGE_EXTRACT, u32StartUs);
+        continue;
+      }
+      gps_ExtractDataRMC(au8Line);
+      u32StartUs = nmeaBench_Stage(pResult, NMEA_BENCH_STAGE_EXTRACT, u32StartUs);
+
+      if (gps_ValidationNMEAData() == false)
+      {
+        nmeaBench_Stage(pResult, NMEA_BENCH_STAGE_VALIDATE, u32StartUs);
+        continue;
+      }
+      u32StartUs = nmeaBench_Stage(pResult, NMEA_BENCH_STAGE_VALIDATE, u32StartUs);
+
+      gps_UpdateGpsData();
+      nmeaBench_Stage(pResult, NMEA_BENCH_STAGE_UPDATE, u32StartUs);
+      pResult->u32Updates++;
+    }
+  }
+  pResult->u32TotalUs = perfMon_GetUs() - u32RunUs;
+
+  memcpy((void *)&GpsData, &sSavedData, sizeof(sGpsData));
+  memcpy((void *)&GpsDataRaw, &sSavedRaw, sizeof(sGpsDataFromGps));
+  xTaskResumeAll();
+}
+
+
+/*
+ * Adds the time since u32StartUs to the stage and returns the new timestamp,
+ * so the next stage starts where this one ended.
+ */
+uint32_t nmeaBench_Stage(sNmeaBenchResult *pResult, eNmeaBenchStage eStage, uint32_t u32StartUs)
+{
+  uint32_t u32NowUs = perfMon_GetUs();
+  pResult->au32Calls[eStage]++;
+  pResult->au32Us[eStage] += u32NowUs - u32StartUs;
+  return u32NowUs;
+}
+
+
+/*
+ * CSV output, one record per line, easy to grep from a serial log:
+ *   NMEA> run,<sentences>,<bytes>,<skipped>,<rejected>,<updates>,<us>,<sentences/s>,<ns/byte>
+ *   NMEA> stage,<name>,<calls>,<us>,<ns/call>
+ */
+void nmeaBench_Print(void)
+{
+  sNmeaBenchResult sResult;
+
+  nmeaBench_Run(NMEA_BENCH_PASSES, &sResult);
+  if (0 == sResult.u32TotalUs)
+  {
+    sResult.u32TotalUs = 1;
+  }
+  printf("%s> run,sentences,bytes,skipped,rejected,updates,us,sentences_s,ns_byte\r\n", NMEA_BENCH_PROMPT);
+  printf("%s> run,%" PRIu32 ",%" PRIu32 ",%" PRIu32 ",%" PRIu32 ",%" PRIu32 ",%" PRIu32 ",%" PRIu32 ",%" PRIu32 "\r\n",
+         NMEA_BENCH_PROMPT, sResult.u32Sentences, sResult.u32Bytes, sResult.u32Skipped, sResult.u32Rejected,
+         sResult.u32Updates,
+         sResult.u32TotalUs, (sResult.u32Sentences * 1000000) / sResult.u32TotalUs,
+         (sResult.u32TotalUs * 1000) / sResult.u32Bytes);
+  printf("%s> stage,name,calls,us,ns_call\r\n", NMEA_BENCH_PROMPT);
+  for (uint8_t u8Stage = 0; u8Stage < NMEA_BENCH_STAGES; u8Stage++)
+  {
+    printf("%s> stage,%s,%" PRIu32 ",%" PRIu32 ",%" PRIu32 "\r\n", NMEA_BENCH_PROMPT,
+           NmeaBenchStageName[u8Stage],
+           sResult.au32Calls[u8Stage], sResult.au32Us[u8Stage],
+           (0 == sResult.au32Calls[u8Stage]) ? 0 :
+           (sResult.au32Us[u8Stage] * 1000) / sResult.au32Calls[u8Stage]);
+  }
+}
@@ -0,0 +1,157 @@
+/*******************************************************************************
+* Filename: perfMon.c
+* Developer: Jorge Yesid Rios Ortiz
+*******************************************************************************/
+
+#include <stdio.h>
+#include <inttypes.h>
+#include <string.h>
+#include "perfMon.h"
+#include "main.h"
+#include "tim.h"
+
+/*
+ * Work item latency monitor. TIM6 runs free at 1 MHz and its overflows extend
+ * the 16 bit counter to a 32 bit microsecond timestamp (wraps after 71 min).
+ */
+
+volatile uint32_t u32PerfMonOverflows = 0;
+sPerfMonItem PerfMonItems[PERF_MON_MAX_ITEMS];
+uint8_t u8PerfMonCount = 0;
+
+uint8_t perfMon_Bucket(uint32_t u32Us);
+
+
+void perfMon_Init(void)
+{
+  u32PerfMonOverflows = 0;
+  __HAL_TIM_SET_COUNTER(&htim6, 0);
+  HAL_TIM_Base_Start_IT(&htim6);
+}
+
+
+void perfMon_TimerOverflow(void)
+{
+  u32PerfMonOverflows++;
+}
+
+
+uint32_t perfMon_GetUs(void)
+{
+  uint32_t u32High = 0;
+  uint32_t u32Low = 0;
+  uint32_t u32Primask = __get_PRIMASK();
+
+  __disable_irq();
+  u32High = u32PerfMonOverflows;
+  u32Low = TIM6->CNT;
+  if ((TIM6->SR & TIM_SR_UIF) && (u32Low < 0x8000))
+  {
+    u32High++;  // wrapped but the overflow interrupt is still pending
+  }
+  __set_PRIMASK(u32Primask);
+  return (u32High << 16) | u32Low;
+}
+
+
+/*
+ * Registers a named work item. Call it from the init code of the owner task.
+ * Returns PERF_MON_INVALID_ID when the table is full.
+ */
+uint8_t perfMon_Register(const char *pName, uint32_t u32BudgetUs)
+{
+  uint8_t u8Id = u8PerfMonCount;
+  if (PERF_MON_MAX_ITEMS <= u8Id)
+  {
+    return PERF_MON_INVALID_ID;
+  }
+  memset(&PerfMonItems[u8Id], 0, sizeof(sPerfMonItem));
+  PerfMonItems[u8Id].pName = pName;
+  PerfMonItems[u8Id].u32BudgetUs = u32BudgetUs;
+  u8PerfMonCount++;
+  return u8Id;
+}
+
+
+void perfMon_Begin(uint8_t u8Id)
+{
+  if (u8PerfMonCount <= u8Id)
+  {
+    return;
+  }
+  PerfMonItems[u8Id].u32StartUs = perfMon_GetUs();
+}
+
+
+uint32_t perfMon_End(uint8_t u8Id)
+{
+  uint32_t u32Elapsed = 0;
+  sPerfMonItem *pItem = NULL;
+  if (u8PerfMonCount <= u8Id)
+  {
+    return 0;
+  }
+  pItem = &PerfMonItems[u8Id];
+  u32Elapsed = perfMon_GetUs() - pItem->u32StartUs;
+  pItem->u32LastUs = u32Elapsed;
+  pItem->u32Count++;
+  if (u32Elapsed > pItem->u32MaxUs)
+  {
+    pItem->u32MaxUs = u32Elapsed;
+  }
+  if (u32Elapsed > pItem->u32BudgetUs)
+  {
+    pItem->u32Misses++;
+  }
+  if (0xFFFF > pItem->au16Histogram[perfMon_Bucket(u32Elapsed)])
+  {
+    pItem->au16Histogram[perfMon_Bucket(u32Elapsed)]++;
+  }
+  return u32Elapsed;
+}
+
+
+uint8_t perfMon_Bucket(uint32_t u32Us)
+{
+  uint8_t u8Bucket = 0;
+  while ((u32Us > 1) && (u8Bucket < (PERF_MON_BUCKETS - 1)))
+  {
+    u32Us >>= 1;
+    u8Bucket++;
+  }
+  return u8Bucket;
+}
+
+
+void perfMon_Print(void)
+{
+  for (uint8_t u8Id = 0; u8Id < u8PerfMonCount; u8Id++)
+  {
+    sPerfMonItem *pItem = &PerfMonItems[u8Id];
+    printf("%s> %s: n=%" PRIu32 " miss=%" PRIu32 " budget=%" PRIu32 "us last=%" PRIu32 "us max=%" PRIu32 "us\r\n", PERF_MON_PROMPT,
+           pItem->pName, pItem->u32Count, pItem->u32Misses, pItem->u32BudgetUs,
+           pItem->u32LastUs, pItem->u32MaxUs);
+    for (uint8_t u8Bucket = 0; u8Bucket < PERF_MON_BUCKETS; u8Bucket++)
+    {
+      if (0 != pItem->au16Histogram[u8Bucket])
+      {
+        printf("   %s%" PRIu32 "us: %u\r\n", (u8Bucket < (PERF_MON_BUCKETS - 1) ? "<" : ">="),
+               (u8Bucket < (PERF_MON_BUCKETS - 1) ? (uint32_t)2 << u8Bucket : (uint32_t)1 << u8Bucket),
+               pItem->au16Histogram[u8Bucket]);
+      }
+    }
+  }
+}
+
+
+void perfMon_Reset(void)
+{
+  for (uint8_t u8Id = 0; u8Id < u8PerfMonCount; u8Id++)
+  {
+    PerfMonItems[u8Id].u32Count = 0;
+    PerfMonItems[u8Id].u32Misses = 0;
+    PerfMonItems[u8Id].u32MaxUs = 0;
+    PerfMonItems[u8Id].u32LastUs = 0;
+    memset(PerfMonItems[u8Id].au16Histogram, 0, sizeof(PerfMonItems[u8Id].au16Histogram));
+  }
+}
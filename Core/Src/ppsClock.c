@@ -0,0 +1,323 @@
+/*******************************************************************************
+* Filename: ppsClock.c
+* Developer: Jorge Yesid Rios Ortiz
+*******************************************************************************/
+
+#include <inttypes.h>
+#include <stdio.h>
+#include <string.h>
+#include "ppsClock.h"
+#include "main.h"
+#include "tim.h"
+#include "cmsis_os.h"
+
+/*
+ * PPS disciplined timebase. TIM3 runs free at 1 MHz (HSI based) and its
+ * overflows extend the 16 bit counter to 32 bits. CH4 captures the PPS edge on
+ * PB1 in hardware, so the interrupt latency does not matter; the EXTI of the
+ * same pin calls ppsClock_Edge(). The ticks measured between edges give the
+ * real length of one second, which corrects the HSI drift when the time since
+ * the last RMC anchor is converted to UTC.
+ *
+ * TIM3 stops in STOP mode: an edge without capture resets the estimator and
+ * the gps task keeps STOP inhibited while edges are arriving.
+ */
+
+sPpsClock PpsClock;
+
+
+void ppsClock_Init(void)
+{
+  memset(&PpsClock, 0, sizeof(PpsClock));
+  ppsClock_EstimatorReset(&PpsClock.sEstimator);
+  __HAL_TIM_SET_COUNTER(&htim3, 0);
+  HAL_TIM_IC_Start(&htim3, TIM_CHANNEL_4);
+  HAL_TIM_Base_Start_IT(&htim3);
+}
+
+
+/*
+ * TIM3 update interrupt. Returns true once per PPS_CLOCK_TIMEOUT_US without
+ * an edge.
+ */
+bool ppsClock_TimerOverflow(void)
+{
+  uint32_t u32Now = 0;
+
+  PpsClock.u32Overflows++;
+  u32Now = ppsClock_GetTicks();
+  if ((u32Now - PpsClock.u32LastEvent) < PPS_CLOCK_TIMEOUT_US)
+  {
+    return false;
+  }
+  PpsClock.u32LastEvent = u32Now;
+  PpsClock.bPresent = false;
+  ppsClock_EstimatorReset(&PpsClock.sEstimator);
+  return true;
+}
+
+
+/*
+ * EXTI of the PPS pin. Returns true when edges start arriving again.
+ */
+bool ppsClock_Edge(void)
+{
+  uint32_t u32Now = 0;
+  uint32_t u32Edge = 0;
+  uint16_t u16Capture = 0;
+  bool bCaptured = false;
+  bool bAcquired = false;
+  uint32_t u32Primask = __get_PRIMASK();
+
+  __disable_irq();
+  u32Now = ppsClock_GetTicks();
+  bCaptured = (0 != (TIM3->SR & TIM_SR_CC4IF));
+  u16Capture = TIM3->CCR4;   // reading clears CC4IF
+  __set_PRIMASK(u32Primask);
+
+  if (true == bCaptured)
+  {
+    u32Edge = u32Now - (uint16_t)((uint16_t)u32Now - u16Capture);   // capture is less than 65ms old
+  }
+  else
+  {
+    u32Edge = u32Now;   // woke up from STOP, TIM3 was not counting
+    ppsClock_EstimatorReset(&PpsClock.sEstimator);
+  }
+  ppsClock_EstimatorUpdate(&PpsClock.sEstimator, u32Edge);
+
+  bAcquired = (false == PpsClock.bPresent);
+  PpsClock.bPresent = true;
+  PpsClock.u32LastEvent = u32Edge;
+  PpsClock.u32Edges++;
+  return bAcquired;
+}
+
+
+uint32_t ppsClock_GetTicks(void)
+{
+  uint32_t u32High = 0;
+  uint32_t u32Low = 0;
+  uint32_t u32Primask = __get_PRIMASK();
+
+  __disable_irq();
+  u32High = PpsClock.u32Overflows;
+  u32Low = TIM3->CNT;
+  if ((TIM3->SR & TIM_SR_UIF) && (u32Low < 0x8000))
+  {
+    u32High++;  // wrapped but the overflow interrupt is still pending
+  }
+  __set_PRIMASK(u32Primask);
+  return (u32High << 16) | u32Low;
+}
+
+
+bool ppsClock_IsPresent(void)
+{
+  return PpsClock.bPresent;
+}
+
+
+bool ppsClock_IsLocked(void)
+{
+  return PpsClock.sEstimator.bLocked;
+}
+
+
+/*
+ * HSI error measured against the PPS, in parts per billion. 0 when unlocked.
+ */
+int32_t ppsClock_GetDriftPpb(void)
+{
+  int32_t i32Diff = 0;
+  if (false == PpsClock.sEstimator.bLocked)
+  {
+    return 0;
+  }
+  i32Diff = (int32_t)PpsClock.sEstimator.u32TicksPerSecQ8 - (int32_t)(PPS_CLOCK_NOMINAL_HZ << 8);
+  return (int32_t)(((int64_t)i32Diff * 1000) / 256);
+}
+
+
+/*
+ * Called with every valid RMC. The time it carries names the second that
+ * started with the last PPS edge, so that edge becomes the anchor when it is
+ * less than one second old. Without PPS the decode time is used instead.
+ * Returns the anchor timestamp, the time of the fix on the TIM3 timebase.
+ */
+uint32_t ppsClock_SetUtc(uint16_t u16Year, uint8_t u8Month, uint8_t u8Day, uint32_t u32SecOfDay)
+{
+  uint32_t u32Now = 0;
+  uint32_t u32Anchor = 0;
+  bool bDisciplined = false;
+
+  taskENTER_CRITICAL();
+  u32Now = ppsClock_GetTicks();
+  u32Anchor = u32Now;
+  if ((true == PpsClock.bPresent) && (true == PpsClock.sEstimator.bHasEdge) &&
+      ((u32Now - PpsClock.sEstimator.u32LastEdge) < PPS_CLOCK_NOMINAL_HZ))
+  {
+    u32Anchor = PpsClock.sEstimator.u32LastEdge;
+    bDisciplined = PpsClock.sEstimator.bLocked;
+  }
+  PpsClock.u32AnchorTicks = u32Anchor;
+  PpsClock.sAnchor.u16Year = u16Year;
+  PpsClock.sAnchor.u8Month = u8Month;
+  PpsClock.sAnchor.u8Day = u8Day;
+  PpsClock.sAnchor.u32SecOfDay = u32SecOfDay;
+  PpsClock.sAnchor.u32Us = 0;
+  PpsClock.sAnchor.bValid = true;
+  PpsClock.sAnchor.bDisciplined = bDisciplined;
+  taskEXIT_CRITICAL();
+  return u32Anchor;
+}
+
+
+/*
+ * Converts a TIM3 timestamp to UTC with the measured length of one second.
+ * The date is the one of the anchor; the seconds wrap at midnight.
+ */
+void ppsClock_TicksToUtc(uint32_t u32Ticks, sPpsClockUtc *pUtc)
+{
+  uint64_t u64ElapsedQ8 = 0;
+  uint32_t u32TicksPerSecQ8 = PPS_CLOCK_NOMINAL_HZ << 8;
+  uint32_t u32Sec = 0;
+  uint32_t u32Rem = 0;
+
+  taskENTER_CRITICAL();
+  *pUtc = PpsClock.sAnchor;
+  u64ElapsedQ8 = (uint64_t)(u32Ticks - PpsClock.u32AnchorTicks) << 8;
+  if (true == PpsClock.sEstimator.bLocked)
+  {
+    u32TicksPerSecQ8 = PpsClock.sEstimator.u32TicksPerSecQ8;
+  }
+  pUtc->bDisciplined = pUtc->bDisciplined && PpsClock.sEstimator.bLocked;
+  taskEXIT_CRITICAL();
+
+  u32Sec = (uint32_t)(u64ElapsedQ8 / u32TicksPerSecQ8);
+  u32Rem = (uint32_t)(u64ElapsedQ8 - ((uint64_t)u32Sec * u32TicksPerSecQ8));
+  pUtc->u32Us = (uint32_t)(((uint64_t)u32Rem * 1000000) / u32TicksPerSecQ8);
+  pUtc->u32SecOfDay = (pUtc->u32SecOfDay + u32Sec) % PPS_CLOCK_SEC_PER_DAY;
+}
+
+
+void ppsClock_GetUtc(sPpsClockUtc *pUtc)
+{
+  ppsClock_TicksToUtc(ppsClock_GetTicks(), pUtc);
+}
+
+
+void ppsClock_EstimatorReset(sPpsClockEstimator *pEst)
+{
+  pEst->u32TicksPerSecQ8 = PPS_CLOCK_NOMINAL_HZ << 8;
+  pEst->u8Good = 0;
+  pEst->u8Outliers = 0;
+  pEst->bHasEdge = false;
+  pEst->bLocked = false;
+}
+
+
+/*
+ * Drift estimator, no hardware access. Feeds one edge timestamp, returns true
+ * when the interval since the previous edge was accepted. Missed edges are
+ * bridged by dividing the interval by the number of seconds it covers.
+ */
+bool ppsClock_EstimatorUpdate(sPpsClockEstimator *pEst, uint32_t u32Edge)
+{
+  uint32_t u32Interval = 0;
+  uint32_t u32Expected = 0;
+  uint32_t u32Seconds = 0;
+  uint32_t u32Period = 0;
+  int32_t i32Error = 0;
+
+  if (false == pEst->bHasEdge)
+  {
+    pEst->u32LastEdge = u32Edge;
+    pEst->bHasEdge = true;
+    return false;
+  }
+  u32Interval = u32Edge - pEst->u32LastEdge;
+  pEst->u32LastEdge = u32Edge;
+
+  u32Expected = (true == pEst->bLocked) ? (pEst->u32TicksPerSecQ8 >> 8) : PPS_CLOCK_NOMINAL_HZ;
+  u32Seconds = (u32Interval + (u32Expected / 2)) / u32Expected;
+  if ((0 == u32Seconds) || (PPS_CLOCK_MAX_GAP < u32Seconds))
+  {
+    pEst->u32Rejected++;
+    pEst->u8Good = 0;
+    pEst->bLocked = false;
+    return false;
+  }
+  u32Period = u32Interval / u32Seconds;
+
+  i32Error = (int32_t)u32Period - PPS_CLOCK_NOMINAL_HZ;
+  if ((i32Error > (PPS_CLOCK_NOMINAL_HZ / 1000000) * PPS_CLOCK_MAX_PPM) ||
+      (i32Error < -(PPS_CLOCK_NOMINAL_HZ / 1000000) * PPS_CLOCK_MAX_PPM))
+  {
+    pEst->u32Rejected++;
+    pEst->u8Good = 0;
+    pEst->bLocked = false;
+    return false;
+  }
+
+  if (true == pEst->bLocked)
+  {
+    i32Error = (int32_t)u32Period - (int32_t)(pEst->u32TicksPerSecQ8 >> 8);
+    if ((i32Error > PPS_CLOCK_JITTER_TICKS) || (i32Error < -PPS_CLOCK_JITTER_TICKS))
+    {
+      pEst->u32Rejected++;
+      pEst->u8Outliers++;
+      if (PPS_CLOCK_MAX_OUTLIERS <= pEst->u8Outliers)
+      {
+        pEst->u8Good = 0;
+        pEst->u8Outliers = 0;
+        pEst->bLocked = false;
+      }
+      return false;
+    }
+  }
+  pEst->u8Outliers = 0;
+
+  if (0 == pEst->u8Good)
+  {
+    pEst->u32TicksPerSecQ8 = u32Period << 8;
+  }
+  else
+  {
+    i32Error = (int32_t)(u32Period << 8) - (int32_t)pEst->u32TicksPerSecQ8;
+    pEst->u32TicksPerSecQ8 += i32Error / (1 << PPS_CLOCK_FILTER_SHIFT);
+  }
+  if (0xFF > pEst->u8Good)
+  {
+    pEst->u8Good++;
+  }
+  pEst->u32Intervals++;
+  if (PPS_CLOCK_LOCK_COUNT <= pEst->u8Good)
+  {
+    pEst->bLocked = true;
+  }
+  return true;
+}
+
+
+void ppsClock_Print(void)
+{
+  sPpsClockUtc sUtc;
+
+  ppsClock_GetUtc(&sUtc);
+  printf("%s> present:%u locked:%u edges:%" PRIu32 " accepted:%" PRIu32 " rejected:%" PRIu32 "\r\n",
+         PPS_CLOCK_PROMPT, PpsClock.bPresent, PpsClock.sEstimator.bLocked, PpsClock.u32Edges,
+         PpsClock.sEstimator.u32Intervals, PpsClock.sEstimator.u32Rejected);
+  printf("%s> ticks/s:%" PRIu32 ".%03" PRIu32 " drift:%" PRId32 "ppb\r\n", PPS_CLOCK_PROMPT,
+         PpsClock.sEstimator.u32TicksPerSecQ8 >> 8,
+         ((PpsClock.sEstimator.u32TicksPerSecQ8 & 0xFF) * 1000) >> 8, ppsClock_GetDriftPpb());
+  if (false == sUtc.bValid)
+  {
+    printf("%s> UTC: no RMC yet\r\n", PPS_CLOCK_PROMPT);
+    return;
+  }
+  printf("%s> UTC: %04u-%02u-%02u %02" PRIu32 ":%02" PRIu32 ":%02" PRIu32 ".%06" PRIu32 " %s\r\n",
+         PPS_CLOCK_PROMPT, sUtc.u16Year, sUtc.u8Month, sUtc.u8Day, sUtc.u32SecOfDay / 3600,
+         (sUtc.u32SecOfDay / 60) % 60, sUtc.u32SecOfDay % 60, sUtc.u32Us,
+         (true == sUtc.bDisciplined) ? "disciplined" : "free running");
+}
@@ -594,7 +594,7 @@ static void tiny_print( struct SStringBuf *apBuf, const char *format, va_list ar
     }
     if( ch == 's' )
     {
-      register char *s = ( char * )va_arg( args, int );
+      register char *s = va_arg( args, char * );
       if( prints( apBuf, s ? s : "(null)" ) == 0 )
       {
         break;
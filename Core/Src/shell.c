@@ -12,14 +12,28 @@
 #include "WDT_Check.h"
 #include "string.h"
 #include "checkPosition.h"
+#include "perfMon.h"
+#include "lowPower.h"
+#include "trace.h"
+#include "nmeaBench.h"
+#include "bench.h"
+#include "ppsClock.h"
+#include "gps.h"
 
 extern UART_HandleTypeDef huart3;
 #define SHELL_UART        huart3
 
 TaskHandle_t shellHandleTask = NULL;     //Task Handle
-SemaphoreHandle_t shellSemaphore = NULL; //task's Semaphore Handle
 QueueHandle_t shellRxQueue = NULL;       //Queue Rx Handle
 TimerHandle_t shellRxTimer = NULL;       //Timer Rx Handle
+uint8_t shellWdtId = WDT_CHECK_INVALID_ID; //health bit given by the watchdog
+uint8_t shellPerfId = PERF_MON_INVALID_ID; //command decode latency
+
+StaticTask_t shellTaskBuffer;                       //task control block
+StackType_t shellTaskStack[SHELL_TASK_STACK_SIZE];  //task stack
+StaticQueue_t shellRxQueueBuffer;                   //Rx queue control block
+uint8_t shellRxQueueStorage[SHELL_RX_BUFFER_SIZE];  //Rx queue storage
+StaticTimer_t shellRxTimerBuffer;                   //Rx timer control block
 
 sShellApp *sShell = NULL;   // Variable control data
 
@@ -36,12 +50,19 @@ void shell_InitFw(void)
 {
   if(NULL == shellHandleTask)
   {
-    xTaskCreate(shell_Task, // Function that implements the task.
+    shellHandleTask = xTaskCreateStatic(shell_Task, // Function that implements the task.
     "ble",                  // Text name for the task.
-    500,                    // Stack size in words, not bytes.
+    SHELL_TASK_STACK_SIZE,  // Stack size in words, not bytes.
     (void*) 1,              // Parameter passed into the task.
     osPriorityNormal,       // Priority at which the task is created.
-    &shellHandleTask);      // Used to pass out the created task's handle.
+    shellTaskStack,         // Stack buffer.
+    &shellTaskBuffer);      // Task control block.
+    if(NULL == shellHandleTask)
+    {
+      Error_Handler();
+    }
+    shellWdtId = WDTCheck_RegisterTask(shell_HealthRequest);
+    shellPerfId = perfMon_Register("shell command", SHELL_CMD_BUDGET_US);
   }
 }
 
@@ -60,24 +81,26 @@ void shell_Task(void *pvParameters)
 
   sShellApp sShellapp;   // Variable control data
   sShell = &sShellapp;   // Variable control data
+  uint32_t u32Notify = 0;
 
   //Create Rx Gsm queue
   if(NULL == shellRxQueue)
   {
-    shellRxQueue = xQueueCreate(SHELL_RX_BUFFER_SIZE, sizeof(uint8_t));
+    shellRxQueue = xQueueCreateStatic(SHELL_RX_BUFFER_SIZE, sizeof(uint8_t), shellRxQueueStorage,
+                                      &shellRxQueueBuffer);
   }
 
   shell_ResetVariables();
 
-  if(NULL == shellSemaphore)
+  if(NULL == shellRxTimer)
   {
-    shellSemaphore = xSemaphoreCreateBinary();
+    shellRxTimer = xTimerCreateStatic("TimerRxFromBle", SHELL_TIME_RX_FROM_BLE_DEFAULT, pdFALSE,
+        (void*) 0, shell_TimerCallbackRxfromShell, &shellRxTimerBuffer);
   }
 
-  if(NULL == shellRxTimer)
+  if(NULL == shellRxQueue || NULL == shellRxTimer)
   {
-    shellRxTimer = xTimerCreate("TimerRxFromBle", SHELL_TIME_RX_FROM_BLE_DEFAULT, pdFALSE,
-        (void*) 0, shell_TimerCallbackRxfromShell);
+    Error_Handler();
   }
 
   shell_InitHw();
@@ -86,18 +109,18 @@ void shell_Task(void *pvParameters)
 
   for (;;)
   {
-    if(xSemaphoreTake(shellSemaphore, portMAX_DELAY) == pdTRUE)
+    if(xTaskNotifyWait(0, UINT32_MAX, &u32Notify, portMAX_DELAY) == pdTRUE)
     {
-      if(true == sShell->sWakeupReason.bRxFromBle)
+      if(0 != (u32Notify & SHELL_NOTIFY_RX_LINE))
       {
-        sShell->sWakeupReason.bRxFromBle = false;
         shell_ExtractLineFromQueue();
+        perfMon_Begin(shellPerfId);
         shell_DecodeDataFromShell();
+        perfMon_End(shellPerfId);
       }
-      if(true == sShell->sWakeupReason.bHealthRequest)
+      if(0 != (u32Notify & SHELL_NOTIFY_HEALTH))
       {
-        sShell->sWakeupReason.bHealthRequest = false;
-        WDTCheck_HealthResponse(WDT_CHECK_TASK_SHELL_CODE);
+        WDTCheck_HealthResponse(shellWdtId);
       }
     }
   }
@@ -107,8 +130,6 @@ void shell_ResetVariables(void)
 {
   sShell->sUart.bReceivingFrame = false;
   shell_ResetUart(true);
-  sShell->sWakeupReason.bRxFromBle = false;
-  sShell->sWakeupReason.bHealthRequest = false;
 }
 
 void shell_ResetUart(bool bResetQueue)
@@ -135,7 +156,7 @@ void shell_ResetUart(bool bResetQueue)
 
 void shell_ReceivedChar(uint8_t RxChar)
 {
-  if(NULL == shellHandleTask || NULL == shellSemaphore || NULL == shellRxTimer)
+  if(NULL == shellHandleTask || NULL == shellRxQueue || NULL == shellRxTimer)
   {
     return;
   }
@@ -151,9 +172,8 @@ void shell_ReceivedChar(uint8_t RxChar)
 
     if(pdTRUE == xQueueIsQueueFullFromISR(shellRxQueue))
     {
-      sShell->sWakeupReason.bRxFromBle = true;
       sShell->sUart.bReceivingFrame = false;
-      xSemaphoreGiveFromISR(shellSemaphore, &xHigherPriorityTaskWoken);
+      xTaskNotifyFromISR(shellHandleTask, SHELL_NOTIFY_RX_LINE, eSetBits, &xHigherPriorityTaskWoken);
       xTimerStopFromISR(shellRxTimer, &xHigherPriorityTaskWoken);
       portYIELD_FROM_ISR(xHigherPriorityTaskWoken);
     }
@@ -168,24 +188,22 @@ void shell_ReceivedChar(uint8_t RxChar)
 
 void shell_HealthRequest(void)
 {
-  if(NULL == shellHandleTask || NULL == shellSemaphore)
+  if(NULL == shellHandleTask)
   {
     return;
   }
-  sShell->sWakeupReason.bHealthRequest = true;
-  xSemaphoreGive(shellSemaphore);
+  xTaskNotify(shellHandleTask, SHELL_NOTIFY_HEALTH, eSetBits);
 }
 
 
 void shell_TimerCallbackRxfromShell(TimerHandle_t xTimer)
 {
-  if(NULL == shellHandleTask || NULL == shellSemaphore)
+  if(NULL == shellHandleTask || NULL == sShell)
   {
     return;
   }
   sShell->sUart.bReceivingFrame = false;
-  sShell->sWakeupReason.bRxFromBle = true;
-  xSemaphoreGive(shellSemaphore);
+  xTaskNotify(shellHandleTask, SHELL_NOTIFY_RX_LINE, eSetBits);
 }
 
 void shell_ExtractLineFromQueue(void)
@@ -302,6 +320,39 @@ void shell_DecodeDataFromShell(void)
     printf("%s> Point:[%f %f] Radius:%f Kms\r\n",SHELL_PROMPT, checkPos_GetLatitude(),
                                  checkPos_GetLongitude(), checkPos_GetEarthRadius());
   }
+  else if (strncmp(sShell->sUart.sRx.Buffer, SHELL_CMD_PPS, SHELL_CMD_PPS_SIZE) == 0)
+  {
+    ppsClock_Print();
+  }
+  else if (strncmp(sShell->sUart.sRx.Buffer, SHELL_CMD_SATS, SHELL_CMD_SATS_SIZE) == 0)
+  {
+    gps_PrintSatellites();
+  }
+  else if (strncmp(sShell->sUart.sRx.Buffer, SHELL_CMD_BENCH, SHELL_CMD_BENCH_SIZE) == 0)
+  {
+    bench_Print();
+  }
+  else if (strncmp(sShell->sUart.sRx.Buffer, SHELL_CMD_NMEA_BENCH, SHELL_CMD_NMEA_BENCH_SIZE) == 0)
+  {
+    nmeaBench_Print();
+  }
+  else if (strncmp(sShell->sUart.sRx.Buffer, SHELL_CMD_TRACE, SHELL_CMD_TRACE_SIZE) == 0)
+  {
+    trace_Dump();
+  }
+  else if (strncmp(sShell->sUart.sRx.Buffer, SHELL_CMD_LOW_POWER, SHELL_CMD_LOW_POWER_SIZE) == 0)
+  {
+    lowPower_Print();
+  }
+  else if (strncmp(sShell->sUart.sRx.Buffer, SHELL_CMD_PERF_RESET, SHELL_CMD_PERF_RESET_SIZE) == 0)
+  {
+    perfMon_Reset();
+    printf("%s> latency histograms cleared\r\n",SHELL_PROMPT);
+  }
+  else if (strncmp(sShell->sUart.sRx.Buffer, SHELL_CMD_PERF, SHELL_CMD_PERF_SIZE) == 0)
+  {
+    perfMon_Print();
+  }
   else
   {
     printf("%s> ERROR\r\n",SHELL_PROMPT);
@@ -26,6 +26,8 @@
 
 #include "gps.h"
 #include "shell.h"
+#include "lowPower.h"
+#include "trace.h"
 /* USER CODE END Includes */
 
 /* Private typedef -----------------------------------------------------------*/
@@ -63,6 +65,9 @@
 extern UART_HandleTypeDef huart1;
 extern UART_HandleTypeDef huart3;
 extern TIM_HandleTypeDef htim1;
+extern TIM_HandleTypeDef htim2;
+extern TIM_HandleTypeDef htim3;
+extern TIM_HandleTypeDef htim6;
 
 /* USER CODE BEGIN EV */
 
@@ -108,17 +113,31 @@ void HardFault_Handler(void)
 /* please refer to the startup file (startup_stm32f0xx.s).                    */
 /******************************************************************************/
 
+/**
+  * @brief This function handles RTC interrupt through EXTI lines 17, 19 and 20.
+  */
+void RTC_IRQHandler(void)
+{
+  /* USER CODE BEGIN RTC_IRQn 0 */
+  lowPower_RtcWakeup();
+  /* USER CODE END RTC_IRQn 0 */
+  /* USER CODE BEGIN RTC_IRQn 1 */
+
+  /* USER CODE END RTC_IRQn 1 */
+}
+
 /**
   * @brief This function handles EXTI line 0 and 1 interrupts.
   */
 void EXTI0_1_IRQHandler(void)
 {
   /* USER CODE BEGIN EXTI0_1_IRQn 0 */
-
+  TRACE_ISR_ENTER(TRACE_ISR_EXTI_PPS);
   /* USER CODE END EXTI0_1_IRQn 0 */
   HAL_GPIO_EXTI_IRQHandler(GPIO_PIN_1);
   /* USER CODE BEGIN EXTI0_1_IRQn 1 */
   gps_PPSReceived();
+  TRACE_ISR_EXIT(TRACE_ISR_EXTI_PPS);
   /* USER CODE END EXTI0_1_IRQn 1 */
 }
 
@@ -128,11 +147,11 @@ void EXTI0_1_IRQHandler(void)
 void EXTI4_15_IRQHandler(void)
 {
   /* USER CODE BEGIN EXTI4_15_IRQn 0 */
-
+  TRACE_ISR_ENTER(TRACE_ISR_EXTI_BUTTON);
   /* USER CODE END EXTI4_15_IRQn 0 */
   HAL_GPIO_EXTI_IRQHandler(GPIO_PIN_13);
   /* USER CODE BEGIN EXTI4_15_IRQn 1 */
-
+  TRACE_ISR_EXIT(TRACE_ISR_EXTI_BUTTON);
   /* USER CODE END EXTI4_15_IRQn 1 */
 }
 
@@ -150,6 +169,48 @@ void TIM1_BRK_UP_TRG_COM_IRQHandler(void)
   /* USER CODE END TIM1_BRK_UP_TRG_COM_IRQn 1 */
 }
 
+/**
+  * @brief This function handles TIM2 global interrupt.
+  */
+void TIM2_IRQHandler(void)
+{
+  /* USER CODE BEGIN TIM2_IRQn 0 */
+
+  /* USER CODE END TIM2_IRQn 0 */
+  HAL_TIM_IRQHandler(&htim2);
+  /* USER CODE BEGIN TIM2_IRQn 1 */
+
+  /* USER CODE END TIM2_IRQn 1 */
+}
+
+/**
+  * @brief This function handles TIM3 global interrupt.
+  */
+void TIM3_IRQHandler(void)
+{
+  /* USER CODE BEGIN TIM3_IRQn 0 */
+
+  /* USER CODE END TIM3_IRQn 0 */
+  HAL_TIM_IRQHandler(&htim3);
+  /* USER CODE BEGIN TIM3_IRQn 1 */
+
+  /* USER CODE END TIM3_IRQn 1 */
+}
+
+/**
+  * @brief This function handles TIM6 global and DAC underrun error interrupts.
+  */
+void TIM6_DAC_IRQHandler(void)
+{
+  /* USER CODE BEGIN TIM6_DAC_IRQn 0 */
+
+  /* USER CODE END TIM6_DAC_IRQn 0 */
+  HAL_TIM_IRQHandler(&htim6);
+  /* USER CODE BEGIN TIM6_DAC_IRQn 1 */
+
+  /* USER CODE END TIM6_DAC_IRQn 1 */
+}
+
 /**
   * @brief This function handles USART1 global interrupt / USART1 wake-up interrupt through EXTI line 25.
   */
@@ -157,6 +218,7 @@ void USART1_IRQHandler(void)
 {
   /* USER CODE BEGIN USART1_IRQn 0 */
   uint8_t rxUartData = 0;
+  TRACE_ISR_ENTER(TRACE_ISR_USART1);
   /* USER CODE END USART1_IRQn 0 */
   HAL_UART_IRQHandler(&huart1);
   /* USER CODE BEGIN USART1_IRQn 1 */
@@ -165,6 +227,7 @@ void USART1_IRQHandler(void)
   {
     gps_ReceiveData(rxUartData);
   }
+  TRACE_ISR_EXIT(TRACE_ISR_USART1);
   /* USER CODE END USART1_IRQn 1 */
 }
 
@@ -178,6 +241,7 @@ void USART3_8_IRQHandler(void)
   uint32_t ui32UartIntSrc = SYSCFG->IT_LINE_SR[29];
   //uint32_t ui32UartIntSrc1 = SCB->ICSR;
   //ui32UartIntSrc1 &= 0x001F;
+  TRACE_ISR_ENTER(TRACE_ISR_USART3);
 
   /* USER CODE END USART3_8_IRQn 0 */
   HAL_UART_IRQHandler(&huart3);
@@ -190,6 +254,7 @@ void USART3_8_IRQHandler(void)
         shell_ReceivedChar(uartRxdata);
       }
     }
+  TRACE_ISR_EXIT(TRACE_ISR_USART3);
   /* USER CODE END USART3_8_IRQn 1 */
 }
 
@@ -0,0 +1,97 @@
+/*******************************************************************************
+* Filename: trace.c
+* Developer: Jorge Yesid Rios Ortiz
+*******************************************************************************/
+
+#include <stdio.h>
+#include <inttypes.h>
+#include <string.h>
+#include "trace.h"
+#include "main.h"
+#include "perfMon.h"
+
+/*
+ * Kernel trace recorder. The FreeRTOS trace macros (FreeRTOSConfig.h) and the
+ * USART/EXTI handlers write 8 byte events into a RAM ring that always keeps
+ * the newest TRACE_RING_SIZE events. "trace" on the shell dumps the ring;
+ * tools/trace2chrome.py turns the dump into a Chrome trace timeline.
+ * Timestamps come from TIM6, which stops while the core is in STOP mode.
+ * Without TRACE_ACTIVE only the shell command is left.
+ */
+
+#if (1==TRACE_ACTIVE)
+
+sTraceEvent TraceRing[TRACE_RING_SIZE];
+volatile uint32_t u32TraceHead = 0;     // total events written
+volatile uint8_t u8TraceFrozen = 0;     // set while dumping
+char TraceTaskNames[TRACE_MAX_TASKS][TRACE_TASK_NAME_LEN];
+
+
+void trace_Record(uint8_t u8Type, uint8_t u8Id, uint16_t u16Param)
+{
+  sTraceEvent *pEvent = NULL;
+  uint32_t u32Primask = __get_PRIMASK();
+
+  __disable_irq();
+  if (0 == u8TraceFrozen)
+  {
+    pEvent = &TraceRing[u32TraceHead & (TRACE_RING_SIZE - 1)];
+    pEvent->u32TimeUs = perfMon_GetUs();
+    pEvent->u8Type = u8Type;
+    pEvent->u8Id = u8Id;
+    pEvent->u16Param = u16Param;
+    u32TraceHead++;
+  }
+  __set_PRIMASK(u32Primask);
+}
+
+
+void trace_TaskCreated(uint32_t u32Number, const char *pName)
+{
+  if (TRACE_MAX_TASKS > u32Number)
+  {
+    strncpy(TraceTaskNames[u32Number], pName, TRACE_TASK_NAME_LEN - 1);
+    TraceTaskNames[u32Number][TRACE_TASK_NAME_LEN - 1] = 0;
+  }
+}
+
+
+/*
+ * Prints the task table and then the ring from the oldest event:
+ *   TRACE> T,<number>,<name>
+ *   TRACE> E,<time us>,<type>,<id>,<param>
+ */
+void trace_Dump(void)
+{
+  uint32_t u32Count = 0;
+  uint32_t u32Index = 0;
+
+  u8TraceFrozen = 1;
+  u32Count = (u32TraceHead < TRACE_RING_SIZE) ? u32TraceHead : TRACE_RING_SIZE;
+  printf("%s> begin %" PRIu32 " events\r\n", TRACE_PROMPT, u32Count);
+  for (uint8_t u8Task = 0; u8Task < TRACE_MAX_TASKS; u8Task++)
+  {
+    if (0 != TraceTaskNames[u8Task][0])
+    {
+      printf("%s> T,%u,%s\r\n", TRACE_PROMPT, u8Task, TraceTaskNames[u8Task]);
+    }
+  }
+  for (u32Index = u32TraceHead - u32Count; u32Index != u32TraceHead; u32Index++)
+  {
+    sTraceEvent *pEvent = &TraceRing[u32Index & (TRACE_RING_SIZE - 1)];
+    printf("%s> E,%" PRIu32 ",%u,%u,%u\r\n", TRACE_PROMPT, pEvent->u32TimeUs,
+           pEvent->u8Type, pEvent->u8Id, pEvent->u16Param);
+  }
+  printf("%s> end\r\n", TRACE_PROMPT);
+  u32TraceHead = 0;
+  u8TraceFrozen = 0;
+}
+
+#else
+
+void trace_Dump(void)
+{
+  printf("%s> not built, define TRACE_ACTIVE=1\r\n", TRACE_PROMPT);
+}
+
+#endif
@@ -33,7 +33,7 @@ void MX_USART1_UART_Init(void)
 {
 
   /* USER CODE BEGIN USART1_Init 0 */
-
+  UART_WakeUpTypeDef WakeUpSelection = {0};
   /* USER CODE END USART1_Init 0 */
 
   /* USER CODE BEGIN USART1_Init 1 */
@@ -54,7 +54,10 @@ void MX_USART1_UART_Init(void)
     Error_Handler();
   }
   /* USER CODE BEGIN USART1_Init 2 */
-
+  // HSI clocked: the receiver keeps running in STOP and the start bit wakes the core
+  WakeUpSelection.WakeUpEvent = UART_WAKEUP_ON_STARTBIT;
+  HAL_UARTEx_StopModeWakeUpSourceConfig(&huart1, WakeUpSelection);
+  HAL_UARTEx_EnableStopMode(&huart1);
   /* USER CODE END USART1_Init 2 */
 
 }
@@ -64,7 +67,7 @@ void MX_USART3_UART_Init(void)
 {
 
   /* USER CODE BEGIN USART3_Init 0 */
-
+  UART_WakeUpTypeDef WakeUpSelection = {0};
   /* USER CODE END USART3_Init 0 */
 
   /* USER CODE BEGIN USART3_Init 1 */
@@ -85,7 +88,10 @@ void MX_USART3_UART_Init(void)
     Error_Handler();
   }
   /* USER CODE BEGIN USART3_Init 2 */
-
+  // HSI clocked: the receiver keeps running in STOP and the start bit wakes the core
+  WakeUpSelection.WakeUpEvent = UART_WAKEUP_ON_STARTBIT;
+  HAL_UARTEx_StopModeWakeUpSourceConfig(&huart3, WakeUpSelection);
+  HAL_UARTEx_EnableStopMode(&huart3);
   /* USER CODE END USART3_Init 2 */
 
 }
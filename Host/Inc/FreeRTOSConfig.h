@@ -0,0 +1,36 @@
+/*******************************************************************************
+* Filename: FreeRTOSConfig.h
+* Developer: Jorge Yesid Rios Ortiz
+*******************************************************************************/
+
+#ifndef __HOST_FREERTOS_CONFIG_H
+#define __HOST_FREERTOS_CONFIG_H
+
+/*
+ * Host build: the kernel configuration of Core/Inc on the Posix port. There
+ * are no Cortex-M vectors to map, the idle task waits for the next tick
+ * instead of entering STOP (lowPower.c is built but its sleep is not used)
+ * and a failed assert names its place and stops the process instead of
+ * spinning with the interrupts masked. Pointers and stack words are 8 bytes
+ * here, so what is still allocated at run time takes twice the 1024 byte
+ * heap of the target.
+ */
+
+#include_next "FreeRTOSConfig.h"
+
+#undef vPortSVCHandler
+#undef xPortPendSVHandler
+#undef xPortSysTickHandler
+#undef portSUPPRESS_TICKS_AND_SLEEP
+
+#undef configTOTAL_HEAP_SIZE
+#define configTOTAL_HEAP_SIZE                    ((size_t)(2 * 1024))
+
+#undef configASSERT
+#define configASSERT( x ) if ((x) == 0) { vAssertCalled( __FILE__, __LINE__ ); }
+
+#if defined(__GNUC__)
+  void vAssertCalled(const char *pcFile, unsigned long ulLine);
+#endif
+
+#endif /* __HOST_FREERTOS_CONFIG_H */
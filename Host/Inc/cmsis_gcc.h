@@ -0,0 +1,161 @@
+/*******************************************************************************
+* Filename: cmsis_gcc.h
+* Developer: Jorge Yesid Rios Ortiz
+*******************************************************************************/
+
+#ifndef __CMSIS_GCC_H
+#define __CMSIS_GCC_H
+
+/*
+ * Host build: takes the place of Drivers/CMSIS/Include/cmsis_gcc.h, same
+ * guard, so no Cortex-M0 inline assembly reaches the host compiler (see
+ * core_cm0.h of this directory). PRIMASK is the tick signal mask of the
+ * calling thread and IPSR is the SysTick exception number while the
+ * simulated interrupt runs, both kept by the Posix port.
+ */
+
+#include <stdint.h>
+
+
+#ifndef   __ASM
+  #define __ASM                                  __asm
+#endif
+#ifndef   __INLINE
+  #define __INLINE                               inline
+#endif
+#ifndef   __STATIC_INLINE
+  #define __STATIC_INLINE                        static inline
+#endif
+#ifndef   __STATIC_FORCEINLINE
+  #define __STATIC_FORCEINLINE                   __attribute__((always_inline)) static inline
+#endif
+#ifndef   __NO_RETURN
+  #define __NO_RETURN                            __attribute__((__noreturn__))
+#endif
+#ifndef   __USED
+  #define __USED                                 __attribute__((used))
+#endif
+#ifndef   __WEAK
+  #define __WEAK                                 __attribute__((weak))
+#endif
+#ifndef   __PACKED
+  #define __PACKED                               __attribute__((packed, aligned(1)))
+#endif
+#ifndef   __PACKED_STRUCT
+  #define __PACKED_STRUCT                        struct __attribute__((packed, aligned(1)))
+#endif
+#ifndef   __PACKED_UNION
+  #define __PACKED_UNION                         union __attribute__((packed, aligned(1)))
+#endif
+#ifndef   __ALIGNED
+  #define __ALIGNED(x)                           __attribute__((aligned(x)))
+#endif
+#ifndef   __RESTRICT
+  #define __RESTRICT                             __restrict
+#endif
+
+#define HOST_CPU_SYSTICK_EXCEPTION    15   // IPSR inside the simulated interrupt
+
+
+// hostCpu.c
+uint32_t hostCpu_GetPrimask(void);
+void hostCpu_SetPrimask(uint32_t u32PriMask);
+uint32_t hostCpu_GetIpsr(void);
+void hostCpu_Nop(void);
+void hostCpu_Wfi(void);
+
+
+__STATIC_FORCEINLINE void __enable_irq(void)
+{
+  hostCpu_SetPrimask(0);
+}
+
+
+__STATIC_FORCEINLINE void __disable_irq(void)
+{
+  hostCpu_SetPrimask(1);
+}
+
+
+__STATIC_FORCEINLINE uint32_t __get_PRIMASK(void)
+{
+  return hostCpu_GetPrimask();
+}
+
+
+__STATIC_FORCEINLINE void __set_PRIMASK(uint32_t priMask)
+{
+  hostCpu_SetPrimask(priMask);
+}
+
+
+__STATIC_FORCEINLINE uint32_t __get_IPSR(void)
+{
+  return hostCpu_GetIpsr();
+}
+
+
+__STATIC_FORCEINLINE uint32_t __get_xPSR(void)
+{
+  return hostCpu_GetIpsr();
+}
+
+
+__STATIC_FORCEINLINE uint32_t __get_CONTROL(void)
+{
+  return 0;
+}
+
+
+__STATIC_FORCEINLINE void __ISB(void)
+{
+  __atomic_thread_fence(__ATOMIC_SEQ_CST);
+}
+
+
+__STATIC_FORCEINLINE void __DSB(void)
+{
+  __atomic_thread_fence(__ATOMIC_SEQ_CST);
+}
+
+
+__STATIC_FORCEINLINE void __DMB(void)
+{
+  __atomic_thread_fence(__ATOMIC_SEQ_CST);
+}
+
+
+__STATIC_FORCEINLINE uint32_t __REV(uint32_t value)
+{
+  return __builtin_bswap32(value);
+}
+
+
+__STATIC_FORCEINLINE uint32_t __REV16(uint32_t value)
+{
+  return ((value & 0xFF00FF00UL) >> 8) | ((value & 0x00FF00FFUL) << 8);
+}
+
+
+__STATIC_FORCEINLINE int16_t __REVSH(int16_t value)
+{
+  return (int16_t)__builtin_bswap16((uint16_t)value);
+}
+
+
+__STATIC_FORCEINLINE uint32_t __ROR(uint32_t op1, uint32_t op2)
+{
+  op2 %= 32U;
+  return (0U == op2) ? op1 : ((op1 >> op2) | (op1 << (32U - op2)));
+}
+
+
+#define __NOP()                             hostCpu_Nop()
+#define __WFI()                             hostCpu_Wfi()
+#define __WFE()                             hostCpu_Wfi()
+#define __SEV()
+#define __BKPT(value)                       __builtin_trap()
+#define __CLZ                               (uint8_t)__builtin_clz
+
+
+#endif /* __CMSIS_GCC_H */
@@ -0,0 +1,19 @@
+/*******************************************************************************
+* Filename: core_cm0.h
+* Developer: Jorge Yesid Rios Ortiz
+*******************************************************************************/
+
+#ifndef __HOST_CORE_CM0_H
+#define __HOST_CORE_CM0_H
+
+/*
+ * Host build: found first on the include path by the device header. The host
+ * cmsis_gcc.h goes in before the CMSIS one, whose guard it shares, and the
+ * rest of core_cm0.h (register types, NVIC and SysTick helpers) is the
+ * original one.
+ */
+
+#include "cmsis_gcc.h"
+#include_next "core_cm0.h"
+
+#endif /* __HOST_CORE_CM0_H */
@@ -0,0 +1,21 @@
+/*******************************************************************************
+* Filename: hostPty.h
+* Developer: Jorge Yesid Rios Ortiz
+*******************************************************************************/
+
+#ifndef __HOST_PTY_H
+#define __HOST_PTY_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+int hostPty_Open(void);
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __HOST_PTY_H */
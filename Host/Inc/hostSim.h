@@ -0,0 +1,44 @@
+/*******************************************************************************
+* Filename: hostSim.h
+* Developer: Jorge Yesid Rios Ortiz
+*******************************************************************************/
+
+#ifndef __HOST_SIM_H
+#define __HOST_SIM_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+#include "stdint.h"
+#include "stdbool.h"
+#include "stm32f0xx.h"
+
+
+#define HOST_SIM_CORE_CLOCK_HZ    48000000UL
+#define HOST_SIM_UART_RX_LEN      4096     // bytes waiting for the simulated line, per UART
+#define HOST_SIM_UART_MAX_BURST   256      // bytes handed over per tick at the unlimited rate
+#define HOST_SIM_UART_UNLIMITED   0        // hostSim_UartSetRate: no line pacing
+#define HOST_SIM_LSI_HZ           40000UL  // IWDG clock
+
+
+// Peripheral model, halShim.c
+bool hostSim_Init(void);
+uint64_t hostSim_Ns(void);
+TIM_TypeDef *hostSim_TimSync(TIM_TypeDef *pTim);
+RTC_TypeDef *hostSim_RtcSync(void);
+SysTick_Type *hostSim_SysTickSync(void);
+void hostSim_UartSetRate(USART_TypeDef *pUart, uint32_t u32BytesPerSecond);
+void hostSim_UartSetTx(USART_TypeDef *pUart, int iFd);
+uint32_t hostSim_UartFeed(USART_TypeDef *pUart, const uint8_t *pData, uint32_t u32Len);
+void hostSim_PpsRequest(uint64_t u64EdgeNs);
+void hostSim_Dispatch(void);
+void hostSim_Reset(const char *pReason);
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __HOST_SIM_H */
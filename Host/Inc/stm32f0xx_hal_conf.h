@@ -0,0 +1,39 @@
+/*******************************************************************************
+* Filename: stm32f0xx_hal_conf.h
+* Developer: Jorge Yesid Rios Ortiz
+*******************************************************************************/
+
+#ifndef __HOST_STM32F0XX_HAL_CONF_H
+#define __HOST_STM32F0XX_HAL_CONF_H
+
+/*
+ * Host build: the HAL configuration of Core/Inc. The CMSIS masks are
+ * unsigned long, 64 bit here, so the flag clears of the TIM HAL write the
+ * complement through uint32_t as the 32 bit register does on the target.
+ * Then the peripherals that count by themselves on the target. Their
+ * registers are plain memory on the host (halShim.c), so every access through
+ * these names first brings the counter up to date with the host clock. A
+ * handle keeps the same Instance pointer, only the reads through the handle
+ * may be one tick old.
+ */
+
+#include_next "stm32f0xx_hal_conf.h"
+#include "hostSim.h"
+
+#undef __HAL_TIM_CLEAR_FLAG
+#undef __HAL_TIM_CLEAR_IT
+#define __HAL_TIM_CLEAR_FLAG(__HANDLE__, __FLAG__)      ((__HANDLE__)->Instance->SR = (uint32_t)~(__FLAG__))
+#define __HAL_TIM_CLEAR_IT(__HANDLE__, __INTERRUPT__)   ((__HANDLE__)->Instance->SR = (uint32_t)~(__INTERRUPT__))
+
+#undef TIM2
+#undef TIM3
+#undef TIM6
+#undef RTC
+#undef SysTick
+#define TIM2       hostSim_TimSync((TIM_TypeDef *)TIM2_BASE)
+#define TIM3       hostSim_TimSync((TIM_TypeDef *)TIM3_BASE)
+#define TIM6       hostSim_TimSync((TIM_TypeDef *)TIM6_BASE)
+#define RTC        hostSim_RtcSync()
+#define SysTick    hostSim_SysTickSync()
+
+#endif /* __HOST_STM32F0XX_HAL_CONF_H */
@@ -0,0 +1,901 @@
+/*******************************************************************************
+* Filename: halShim.c
+* Developer: Jorge Yesid Rios Ortiz
+*******************************************************************************/
+
+#define _GNU_SOURCE
+#include <errno.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <time.h>
+#include <unistd.h>
+#include "main.h"
+#include "stm32f0xx_it.h"
+#include "FreeRTOS.h"
+#include "hostSim.h"
+
+/*
+ * Peripheral model and HAL subset of the host build. The peripheral blocks
+ * and the system control space are mapped at their addresses of the
+ * STM32F091, so the application, the HAL macros and the CMSIS helpers access
+ * the same registers as on the target. What runs by itself on the target is
+ * brought up to date from the host clock when it is read:
+ * - TIM2, TIM3 and TIM6 count at 48MHz / (PSC + 1) and wrap at ARR, a wrap
+ *   sets UIF and the TIM2 CH1 toggle moves LD2
+ * - the RTC calendar and subseconds run from the start of the process
+ * - SysTick counts down over its 24 bits
+ * - the UARTs deliver one byte per RXNE at the line rate
+ * The HAL functions only do what the application reads back afterwards.
+ * The interrupt handlers are the ones of stm32f0xx_it.c, see
+ * hostSim_Dispatch.
+ */
+
+#define HOST_SIM_NS_PER_S          1000000000ULL
+#define HOST_SIM_TIM_COUNT         3
+#define HOST_SIM_UART_COUNT        2
+
+#ifndef MAP_FIXED_NOREPLACE
+  #define MAP_FIXED_NOREPLACE      0x100000
+#endif
+
+
+typedef struct
+{
+  uintptr_t uBase;
+  size_t uSize;
+} sHostRegion;
+
+
+typedef struct
+{
+  TIM_TypeDef *pTim;
+  uint64_t u64LastCycles;
+  uint64_t u64Residue;       // cycles not making a whole count yet
+  uint32_t u32Cnt;           // CNT as left by the model, anything else was written by the application
+} sHostTim;
+
+
+typedef struct
+{
+  USART_TypeDef *pUart;
+  int iTxFd;                 // HAL_UART_Transmit destination, -1 drops the bytes
+  bool bRateSet;             // hostSim_UartSetRate wins over the baud rate of HAL_UART_Init
+  uint32_t u32Rate;          // bytes per second on the line
+  uint64_t u64BurstNs;       // start of the bytes without a pause, 0 when the line is idle
+  uint64_t u64BurstBytes;
+  _Atomic uint32_t u32Head;  // feeding thread
+  _Atomic uint32_t u32Tail;  // interrupt
+  uint8_t au8Rx[HOST_SIM_UART_RX_LEN];
+} sHostUart;
+
+
+typedef struct
+{
+  bool bRunning;
+  uint64_t u64TimeoutNs;
+  volatile uint64_t u64RefreshNs;
+} sHostIwdg;
+
+
+static const sHostRegion HostRegions[] =
+{
+  { APBPERIPH_BASE,  0x00030000 },   // APB and AHB1: timers, RTC, IWDG, USART, SYSCFG, EXTI, RCC
+  { AHB2PERIPH_BASE, 0x00002000 },   // GPIO
+  { SCS_BASE,        0x00001000 },   // SysTick, NVIC, SCB
+};
+
+static struct timespec HostStart;
+static sHostTim HostTims[HOST_SIM_TIM_COUNT] =
+{
+  { (TIM_TypeDef *)TIM2_BASE }, { (TIM_TypeDef *)TIM3_BASE }, { (TIM_TypeDef *)TIM6_BASE }
+};
+static sHostUart HostUarts[HOST_SIM_UART_COUNT] =
+{
+  { .pUart = (USART_TypeDef *)USART1_BASE, .iTxFd = -1 },
+  { .pUart = (USART_TypeDef *)USART3_BASE, .iTxFd = STDOUT_FILENO }
+};
+static sHostIwdg HostIwdg;
+static uint64_t u64HostSysTickPeriod = 0;
+static volatile uint32_t u32HostNvicEnabled = 0;
+static _Atomic uint64_t u64HostPpsEdgeNs = 0;   // 0: no edge pending
+
+uint32_t SystemCoreClock = HOST_SIM_CORE_CLOCK_HZ;
+
+// HAL timebase of stm32f0xx_hal_timebase_tim.c, HAL_GetTick is the host clock here
+TIM_HandleTypeDef htim1;
+
+static bool hostSim_Map(uintptr_t uBase, size_t uSize);
+static uint64_t hostSim_Cycles(void);
+static sHostTim *hostSim_FindTim(TIM_TypeDef *pTim);
+static sHostUart *hostSim_FindUart(USART_TypeDef *pUart);
+static uint32_t hostSim_Bcd(uint32_t u32Value);
+static bool hostSim_UartRxPoll(USART_TypeDef *pUart);
+static bool hostSim_UartRead(USART_TypeDef *pUart, uint8_t *pu8Data);
+static bool hostSim_IrqEnabled(IRQn_Type eIrq);
+static void hostSim_Tim(TIM_TypeDef *pTim, IRQn_Type eIrq, void (*pHandler)(void));
+static void hostSim_Uart(USART_TypeDef *pUart, IRQn_Type eIrq, void (*pHandler)(void));
+static void hostSim_PpsPoll(void);
+static void hostSim_IwdgCheck(void);
+
+
+// Before the firmware main
+bool hostSim_Init(void)
+{
+  clock_gettime(CLOCK_MONOTONIC, &HostStart);
+  for (uint32_t u32Region = 0; u32Region < (sizeof(HostRegions) / sizeof(HostRegions[0])); u32Region++)
+  {
+    if (false == hostSim_Map(HostRegions[u32Region].uBase, HostRegions[u32Region].uSize))
+    {
+      return false;
+    }
+  }
+
+  // Reset values the application reads before writing them
+  RCC->CSR = RCC_CSR_PORRSTF;
+  ((RTC_TypeDef *)RTC_BASE)->PRER = 0x007F00FF;
+  ((SysTick_Type *)SysTick_BASE)->LOAD = SysTick_LOAD_RELOAD_Msk;
+  ((SysTick_Type *)SysTick_BASE)->CTRL = SysTick_CTRL_CLKSOURCE_Msk | SysTick_CTRL_ENABLE_Msk;
+  for (uint32_t u32Uart = 0; u32Uart < HOST_SIM_UART_COUNT; u32Uart++)
+  {
+    HostUarts[u32Uart].pUart->ISR = USART_ISR_TXE | USART_ISR_TC;
+  }
+  return true;
+}
+
+
+uint64_t hostSim_Ns(void)
+{
+  struct timespec sNow;
+
+  clock_gettime(CLOCK_MONOTONIC, &sNow);
+  return ((uint64_t)(sNow.tv_sec - HostStart.tv_sec) * HOST_SIM_NS_PER_S) + (uint64_t)sNow.tv_nsec -
+         (uint64_t)HostStart.tv_nsec;
+}
+
+
+TIM_TypeDef *hostSim_TimSync(TIM_TypeDef *pTim)
+{
+  sHostTim *pModel = hostSim_FindTim(pTim);
+  uint32_t u32Primask = 0;
+  uint64_t u64Now = 0;
+  uint64_t u64Counts = 0;
+  uint64_t u64Period = 0;
+  uint64_t u64Wraps = 0;
+
+  if (NULL == pModel)
+  {
+    return pTim;
+  }
+  u32Primask = hostCpu_GetPrimask();
+  hostCpu_SetPrimask(1);
+  u64Now = hostSim_Cycles();
+  if (0 == (pTim->CR1 & TIM_CR1_CEN))
+  {
+    pModel->u64LastCycles = u64Now;
+    pModel->u64Residue = 0;
+    pModel->u32Cnt = pTim->CNT;
+    hostCpu_SetPrimask(u32Primask);
+    return pTim;
+  }
+  if (pTim->CNT != pModel->u32Cnt)
+  {
+    pModel->u32Cnt = pTim->CNT;   // __HAL_TIM_SET_COUNTER
+  }
+  u64Counts = (u64Now - pModel->u64LastCycles) + pModel->u64Residue;
+  pModel->u64Residue = u64Counts % ((uint64_t)pTim->PSC + 1);
+  u64Counts /= ((uint64_t)pTim->PSC + 1);
+  pModel->u64LastCycles = u64Now;
+
+  u64Period = (uint64_t)pTim->ARR + 1;
+  u64Counts += pModel->u32Cnt;
+  u64Wraps = u64Counts / u64Period;
+  pModel->u32Cnt = (uint32_t)(u64Counts % u64Period);
+  pTim->CNT = pModel->u32Cnt;
+  if (0 != u64Wraps)
+  {
+    pTim->SR |= TIM_SR_UIF;
+    // CCR1 is 0 in MX_TIM2_Init: the toggle match is the update, LD2 is TIM2_CH1
+    if ((TIM2_BASE == (uintptr_t)pTim) && (0 != (pTim->CCER & TIM_CCER_CC1E)) &&
+        (TIM_OCMODE_TOGGLE == (pTim->CCMR1 & TIM_CCMR1_OC1M)) && (0 != (u64Wraps & 1)))
+    {
+      ((GPIO_TypeDef *)GPIOA_BASE)->IDR ^= LD2_Pin;
+    }
+  }
+  hostCpu_SetPrimask(u32Primask);
+  return pTim;
+}
+
+
+RTC_TypeDef *hostSim_RtcSync(void)
+{
+  RTC_TypeDef *pRtc = (RTC_TypeDef *)RTC_BASE;
+  uint64_t u64Ms = hostSim_Ns() / 1000000ULL;
+  uint32_t u32PredivS = pRtc->PRER & RTC_PRER_PREDIV_S;
+  uint32_t u32Seconds = (uint32_t)((u64Ms / 1000) % 86400);
+
+  // Initialisation, wakeup timer writes and shadow registers are always ready
+  pRtc->ISR |= RTC_ISR_INITF | RTC_ISR_WUTWF | RTC_ISR_RSF | RTC_ISR_INITS;
+  pRtc->SSR = u32PredivS - (uint32_t)(((u64Ms % 1000) * (u32PredivS + 1)) / 1000);
+  pRtc->TR = (hostSim_Bcd(u32Seconds / 3600) << RTC_TR_HU_Pos) |
+             (hostSim_Bcd((u32Seconds / 60) % 60) << RTC_TR_MNU_Pos) |
+             (hostSim_Bcd(u32Seconds % 60) << RTC_TR_SU_Pos);
+  return pRtc;
+}
+
+
+// COUNTFLAG reports a wrap since the previous access through SysTick
+SysTick_Type *hostSim_SysTickSync(void)
+{
+  SysTick_Type *pSysTick = (SysTick_Type *)SysTick_BASE;
+  uint64_t u64Cycles = hostSim_Cycles();
+  uint64_t u64Reload = (uint64_t)(pSysTick->LOAD & SysTick_LOAD_RELOAD_Msk) + 1;
+  uint64_t u64Period = u64Cycles / u64Reload;
+
+  pSysTick->VAL = (uint32_t)(u64Reload - 1 - (u64Cycles % u64Reload));
+  if (u64Period != u64HostSysTickPeriod)
+  {
+    pSysTick->CTRL |= SysTick_CTRL_COUNTFLAG_Msk;
+  }
+  else
+  {
+    pSysTick->CTRL &= ~SysTick_CTRL_COUNTFLAG_Msk;
+  }
+  u64HostSysTickPeriod = u64Period;
+  return pSysTick;
+}
+
+
+/*
+ * Line rate of the received bytes, HOST_SIM_UART_UNLIMITED hands over up to
+ * HOST_SIM_UART_MAX_BURST bytes per millisecond. Without a call the rate
+ * follows the baud rate of HAL_UART_Init.
+ */
+void hostSim_UartSetRate(USART_TypeDef *pUart, uint32_t u32BytesPerSecond)
+{
+  sHostUart *pModel = hostSim_FindUart(pUart);
+
+  if (NULL != pModel)
+  {
+    pModel->u32Rate = (HOST_SIM_UART_UNLIMITED == u32BytesPerSecond) ?
+                      (HOST_SIM_UART_MAX_BURST * 1000) : u32BytesPerSecond;
+    pModel->bRateSet = true;
+  }
+}
+
+
+void hostSim_UartSetTx(USART_TypeDef *pUart, int iFd)
+{
+  sHostUart *pModel = hostSim_FindUart(pUart);
+
+  if (NULL != pModel)
+  {
+    pModel->iTxFd = iFd;
+  }
+}
+
+
+// Any host thread. Returns the bytes taken, fewer than u32Len when the line is behind
+uint32_t hostSim_UartFeed(USART_TypeDef *pUart, const uint8_t *pData, uint32_t u32Len)
+{
+  sHostUart *pModel = hostSim_FindUart(pUart);
+  uint32_t u32Head = 0;
+  uint32_t u32Free = 0;
+
+  if (NULL == pModel)
+  {
+    return 0;
+  }
+  u32Head = atomic_load_explicit(&pModel->u32Head, memory_order_relaxed);
+  u32Free = HOST_SIM_UART_RX_LEN - (u32Head - atomic_load_explicit(&pModel->u32Tail, memory_order_acquire));
+  if (u32Len > u32Free)
+  {
+    u32Len = u32Free;
+  }
+  for (uint32_t u32Pos = 0; u32Pos < u32Len; u32Pos++)
+  {
+    pModel->au8Rx[(u32Head + u32Pos) % HOST_SIM_UART_RX_LEN] = pData[u32Pos];
+  }
+  atomic_store_explicit(&pModel->u32Head, u32Head + u32Len, memory_order_release);
+  return u32Len;
+}
+
+
+/*
+ * Any host thread: a PPS edge at u64EdgeNs (hostSim_Ns), which may be a
+ * little in the past. The EXTI runs at the next interrupt, the capture holds
+ * the count of the edge itself, as the input capture does on the target.
+ */
+void hostSim_PpsRequest(uint64_t u64EdgeNs)
+{
+  atomic_store(&u64HostPpsEdgeNs, (0 == u64EdgeNs) ? 1 : u64EdgeNs);
+}
+
+
+/*
+ * The Posix port calls this from its tick signal before the tick, with the
+ * kernel interrupts masked, so the handlers of stm32f0xx_it.c see the same
+ * context as on the target. A pending source runs its handler when the
+ * peripheral and NVIC enables are set, in the order of the vector table.
+ * The RTC wakeup and the user button have no host source: the idle task does
+ * not enter STOP on the host and nothing presses B1.
+ */
+void hostSim_Dispatch(void)
+{
+  hostSim_PpsPoll();
+  if ((0 != (EXTI->PR & EXTI->IMR & (GPIO_PIN_0 | GPIO_PIN_1))) && (true == hostSim_IrqEnabled(EXTI0_1_IRQn)))
+  {
+    EXTI0_1_IRQHandler();
+  }
+  hostSim_Tim((TIM_TypeDef *)TIM2_BASE, TIM2_IRQn, TIM2_IRQHandler);
+  hostSim_Tim((TIM_TypeDef *)TIM3_BASE, TIM3_IRQn, TIM3_IRQHandler);
+  hostSim_Tim((TIM_TypeDef *)TIM6_BASE, TIM6_DAC_IRQn, TIM6_DAC_IRQHandler);
+  hostSim_Uart((USART_TypeDef *)USART1_BASE, USART1_IRQn, USART1_IRQHandler);
+  hostSim_Uart((USART_TypeDef *)USART3_BASE, USART3_8_IRQn, USART3_8_IRQHandler);
+  hostSim_IwdgCheck();
+}
+
+
+// A target reset ends the process, the no-init RAM does not survive it here
+void hostSim_Reset(const char *pReason)
+{
+  fprintf(stderr, "\nhost: reset, %s\n", pReason);
+  exit(3);
+}
+
+
+/******************************************************************************
+ * HAL
+ ******************************************************************************/
+
+HAL_StatusTypeDef HAL_Init(void)
+{
+  HAL_MspInit();
+  return HAL_OK;
+}
+
+
+uint32_t HAL_GetTick(void)
+{
+  return (uint32_t)(hostSim_Ns() / 1000000ULL);
+}
+
+
+void HAL_IncTick(void)
+{
+}
+
+
+void HAL_Delay(uint32_t Delay)
+{
+  struct timespec sDelay = { Delay / 1000, (long)(Delay % 1000) * 1000000L };
+
+  nanosleep(&sDelay, NULL);
+}
+
+
+void HAL_SuspendTick(void)
+{
+}
+
+
+void HAL_ResumeTick(void)
+{
+}
+
+
+void HAL_NVIC_SetPriority(IRQn_Type IRQn, uint32_t PreemptPriority, uint32_t SubPriority)
+{
+  (void)IRQn;
+  (void)PreemptPriority;
+  (void)SubPriority;
+}
+
+
+void HAL_NVIC_EnableIRQ(IRQn_Type IRQn)
+{
+  if (0 <= IRQn)
+  {
+    u32HostNvicEnabled |= (1UL << (uint32_t)IRQn);
+  }
+}
+
+
+void HAL_NVIC_DisableIRQ(IRQn_Type IRQn)
+{
+  if (0 <= IRQn)
+  {
+    u32HostNvicEnabled &= ~(1UL << (uint32_t)IRQn);
+  }
+}
+
+
+HAL_StatusTypeDef HAL_RCC_OscConfig(RCC_OscInitTypeDef *RCC_OscInitStruct)
+{
+  (void)RCC_OscInitStruct;
+  return HAL_OK;
+}
+
+
+HAL_StatusTypeDef HAL_RCC_ClockConfig(RCC_ClkInitTypeDef *RCC_ClkInitStruct, uint32_t FLatency)
+{
+  (void)RCC_ClkInitStruct;
+  (void)FLatency;
+  SystemCoreClock = HOST_SIM_CORE_CLOCK_HZ;
+  return HAL_OK;
+}
+
+
+HAL_StatusTypeDef HAL_RCCEx_PeriphCLKConfig(RCC_PeriphCLKInitTypeDef *PeriphClkInit)
+{
+  (void)PeriphClkInit;
+  return HAL_OK;
+}
+
+
+void HAL_PWR_EnterSTOPMode(uint32_t Regulator, uint8_t STOPEntry)
+{
+  (void)Regulator;
+  (void)STOPEntry;
+}
+
+
+void HAL_PWR_EnableBkUpAccess(void)
+{
+}
+
+
+// Only the EXTI lines, the pin modes are not modelled
+void HAL_GPIO_Init(GPIO_TypeDef *GPIOx, GPIO_InitTypeDef *GPIO_Init)
+{
+  (void)GPIOx;
+  if (0 != (GPIO_Init->Mode & EXTI_IT))
+  {
+    EXTI->IMR |= GPIO_Init->Pin;
+  }
+}
+
+
+void HAL_GPIO_DeInit(GPIO_TypeDef *GPIOx, uint32_t GPIO_Pin)
+{
+  (void)GPIOx;
+  EXTI->IMR &= ~GPIO_Pin;
+}
+
+
+GPIO_PinState HAL_GPIO_ReadPin(GPIO_TypeDef *GPIOx, uint16_t GPIO_Pin)
+{
+  return (0 != (GPIOx->IDR & GPIO_Pin)) ? GPIO_PIN_SET : GPIO_PIN_RESET;
+}
+
+
+void HAL_GPIO_WritePin(GPIO_TypeDef *GPIOx, uint16_t GPIO_Pin, GPIO_PinState PinState)
+{
+  if (GPIO_PIN_RESET != PinState)
+  {
+    GPIOx->ODR |= GPIO_Pin;
+    GPIOx->IDR |= GPIO_Pin;
+  }
+  else
+  {
+    GPIOx->ODR &= ~(uint32_t)GPIO_Pin;
+    GPIOx->IDR &= ~(uint32_t)GPIO_Pin;
+  }
+}
+
+
+void HAL_GPIO_TogglePin(GPIO_TypeDef *GPIOx, uint16_t GPIO_Pin)
+{
+  HAL_GPIO_WritePin(GPIOx, GPIO_Pin, (0 != (GPIOx->ODR & GPIO_Pin)) ? GPIO_PIN_RESET : GPIO_PIN_SET);
+}
+
+
+void HAL_GPIO_EXTI_IRQHandler(uint16_t GPIO_Pin)
+{
+  if (0 != (EXTI->PR & GPIO_Pin))
+  {
+    EXTI->PR &= ~(uint32_t)GPIO_Pin;   // write 1 to clear on the target
+    HAL_GPIO_EXTI_Callback(GPIO_Pin);
+  }
+}
+
+
+__weak void HAL_GPIO_EXTI_Callback(uint16_t GPIO_Pin)
+{
+  (void)GPIO_Pin;
+}
+
+
+HAL_StatusTypeDef HAL_UART_Init(UART_HandleTypeDef *huart)
+{
+  sHostUart *pModel = hostSim_FindUart(huart->Instance);
+
+  HAL_UART_MspInit(huart);
+  if ((NULL != pModel) && (false == pModel->bRateSet))
+  {
+    pModel->u32Rate = huart->Init.BaudRate / 10;   // start, 8 data and stop bits
+  }
+  huart->Instance->BRR = HOST_SIM_CORE_CLOCK_HZ / huart->Init.BaudRate;
+  huart->Instance->CR1 |= USART_CR1_UE | USART_CR1_TE | USART_CR1_RE;
+  huart->gState = HAL_UART_STATE_READY;
+  huart->RxState = HAL_UART_STATE_READY;
+  return HAL_OK;
+}
+
+
+HAL_StatusTypeDef HAL_UART_Transmit(UART_HandleTypeDef *huart, uint8_t *pData, uint16_t Size, uint32_t Timeout)
+{
+  sHostUart *pModel = hostSim_FindUart(huart->Instance);
+  ssize_t xWritten = 0;
+
+  (void)Timeout;
+  if ((NULL == pModel) || (0 > pModel->iTxFd))
+  {
+    return HAL_OK;
+  }
+  while (0 < Size)
+  {
+    xWritten = write(pModel->iTxFd, pData, Size);
+    if (0 >= xWritten)
+    {
+      if ((0 > xWritten) && (EINTR == errno))
+      {
+        continue;   // the tick interrupted the transfer before any byte
+      }
+      return HAL_ERROR;
+    }
+    pData += xWritten;
+    Size -= (uint16_t)xWritten;
+  }
+  return HAL_OK;
+}
+
+
+// Errors are not modelled, the byte is taken by HAL_UART_Receive_IT
+void HAL_UART_IRQHandler(UART_HandleTypeDef *huart)
+{
+  (void)huart;
+}
+
+
+// The byte the line has delivered, HAL_ERROR when RXNE is not set
+HAL_StatusTypeDef HAL_UART_Receive_IT(UART_HandleTypeDef *huart, uint8_t *pData, uint16_t Size)
+{
+  if ((1 != Size) || (false == hostSim_UartRead(huart->Instance, pData)))
+  {
+    return HAL_ERROR;
+  }
+  return HAL_OK;
+}
+
+
+HAL_StatusTypeDef HAL_UARTEx_StopModeWakeUpSourceConfig(UART_HandleTypeDef *huart,
+                                                        UART_WakeUpTypeDef WakeUpSelection)
+{
+  (void)huart;
+  (void)WakeUpSelection;
+  return HAL_OK;
+}
+
+
+HAL_StatusTypeDef HAL_UARTEx_EnableStopMode(UART_HandleTypeDef *huart)
+{
+  (void)huart;
+  return HAL_OK;
+}
+
+
+HAL_StatusTypeDef HAL_TIM_Base_Init(TIM_HandleTypeDef *htim)
+{
+  HAL_TIM_Base_MspInit(htim);
+  htim->Instance->PSC = htim->Init.Prescaler;
+  htim->Instance->ARR = htim->Init.Period;
+  htim->Instance->CR1 = (htim->Instance->CR1 & ~TIM_CR1_ARPE) | htim->Init.AutoReloadPreload;
+  htim->State = HAL_TIM_STATE_READY;
+  return HAL_OK;
+}
+
+
+HAL_StatusTypeDef HAL_TIM_OC_Init(TIM_HandleTypeDef *htim)
+{
+  htim->State = HAL_TIM_STATE_READY;
+  return HAL_OK;
+}
+
+
+HAL_StatusTypeDef HAL_TIM_IC_Init(TIM_HandleTypeDef *htim)
+{
+  htim->State = HAL_TIM_STATE_READY;
+  return HAL_OK;
+}
+
+
+HAL_StatusTypeDef HAL_TIM_ConfigClockSource(TIM_HandleTypeDef *htim, TIM_ClockConfigTypeDef *sClockSourceConfig)
+{
+  (void)htim;
+  (void)sClockSourceConfig;
+  return HAL_OK;
+}
+
+
+HAL_StatusTypeDef HAL_TIMEx_MasterConfigSynchronization(TIM_HandleTypeDef *htim,
+                                                        TIM_MasterConfigTypeDef *sMasterConfig)
+{
+  (void)htim;
+  (void)sMasterConfig;
+  return HAL_OK;
+}
+
+
+// Channel 1 is the only output compare of the application
+HAL_StatusTypeDef HAL_TIM_OC_ConfigChannel(TIM_HandleTypeDef *htim, TIM_OC_InitTypeDef *sConfig, uint32_t Channel)
+{
+  if (TIM_CHANNEL_1 != Channel)
+  {
+    return HAL_ERROR;
+  }
+  htim->Instance->CCMR1 = (htim->Instance->CCMR1 & ~(TIM_CCMR1_OC1M | TIM_CCMR1_CC1S)) | sConfig->OCMode;
+  htim->Instance->CCR1 = sConfig->Pulse;
+  return HAL_OK;
+}
+
+
+HAL_StatusTypeDef HAL_TIM_IC_ConfigChannel(TIM_HandleTypeDef *htim, TIM_IC_InitTypeDef *sConfig, uint32_t Channel)
+{
+  (void)htim;
+  (void)sConfig;
+  (void)Channel;
+  return HAL_OK;
+}
+
+
+HAL_StatusTypeDef HAL_TIM_OC_Start(TIM_HandleTypeDef *htim, uint32_t Channel)
+{
+  htim->Instance->CCER |= (TIM_CCER_CC1E << (Channel & 0x1FU));
+  hostSim_TimSync(htim->Instance);
+  htim->Instance->CR1 |= TIM_CR1_CEN;
+  return HAL_OK;
+}
+
+
+HAL_StatusTypeDef HAL_TIM_IC_Start(TIM_HandleTypeDef *htim, uint32_t Channel)
+{
+  return HAL_TIM_OC_Start(htim, Channel);
+}
+
+
+HAL_StatusTypeDef HAL_TIM_Base_Start(TIM_HandleTypeDef *htim)
+{
+  hostSim_TimSync(htim->Instance);
+  htim->Instance->CR1 |= TIM_CR1_CEN;
+  return HAL_OK;
+}
+
+
+HAL_StatusTypeDef HAL_TIM_Base_Start_IT(TIM_HandleTypeDef *htim)
+{
+  htim->Instance->DIER |= TIM_DIER_UIE;
+  return HAL_TIM_Base_Start(htim);
+}
+
+
+// The update is the only timer interrupt the application enables
+void HAL_TIM_IRQHandler(TIM_HandleTypeDef *htim)
+{
+  if ((0 != (htim->Instance->SR & TIM_SR_UIF)) && (0 != (htim->Instance->DIER & TIM_DIER_UIE)))
+  {
+    htim->Instance->SR &= ~TIM_SR_UIF;
+    HAL_TIM_PeriodElapsedCallback(htim);
+  }
+}
+
+
+HAL_StatusTypeDef HAL_IWDG_Init(IWDG_HandleTypeDef *hiwdg)
+{
+  HostIwdg.u64TimeoutNs = ((uint64_t)(hiwdg->Init.Reload + 1) * (4ULL << hiwdg->Init.Prescaler) *
+                           HOST_SIM_NS_PER_S) / HOST_SIM_LSI_HZ;
+  HostIwdg.u64RefreshNs = hostSim_Ns();
+  HostIwdg.bRunning = true;
+  return HAL_OK;
+}
+
+
+HAL_StatusTypeDef HAL_IWDG_Refresh(IWDG_HandleTypeDef *hiwdg)
+{
+  (void)hiwdg;
+  HostIwdg.u64RefreshNs = hostSim_Ns();
+  return HAL_OK;
+}
+
+
+/******************************************************************************
+ * Local
+ ******************************************************************************/
+
+static bool hostSim_Map(uintptr_t uBase, size_t uSize)
+{
+  void *pMap = mmap((void *)uBase, uSize, PROT_READ | PROT_WRITE,
+                    MAP_PRIVATE | MAP_ANONYMOUS | MAP_FIXED_NOREPLACE, -1, 0);
+
+  if ((void *)uBase != pMap)
+  {
+    fprintf(stderr, "host: cannot map 0x%08lx, %s\n", (unsigned long)uBase, strerror(errno));
+    if (MAP_FAILED != pMap)
+    {
+      munmap(pMap, uSize);   // old kernel, the address was taken as a hint
+    }
+    return false;
+  }
+  return true;
+}
+
+
+static void hostSim_Tim(TIM_TypeDef *pTim, IRQn_Type eIrq, void (*pHandler)(void))
+{
+  hostSim_TimSync(pTim);
+  if ((0 != (pTim->SR & pTim->DIER & TIM_SR_UIF)) && (true == hostSim_IrqEnabled(eIrq)))
+  {
+    pHandler();
+  }
+}
+
+
+/*
+ * One interrupt per byte the simulated line has delivered, at most a burst
+ * per tick: the unlimited rate must not keep the tick waiting. USART3 shares
+ * its vector, SYSCFG tells its handler the source.
+ */
+static void hostSim_Uart(USART_TypeDef *pUart, IRQn_Type eIrq, void (*pHandler)(void))
+{
+  uint32_t u32Burst = 0;
+
+  while ((HOST_SIM_UART_MAX_BURST > u32Burst++) && (true == hostSim_IrqEnabled(eIrq)) &&
+         (0 != (pUart->CR1 & USART_CR1_RXNEIE)) && (true == hostSim_UartRxPoll(pUart)))
+  {
+    if (USART3_8_IRQn == eIrq)
+    {
+      SYSCFG->IT_LINE_SR[29] = SYSCFG_ITLINE29_SR_USART3_GLB;
+    }
+    pHandler();
+    SYSCFG->IT_LINE_SR[29] = 0;
+  }
+}
+
+
+// Interrupt context: puts the next byte in RDR when the line has delivered it, true while RXNE is set
+static bool hostSim_UartRxPoll(USART_TypeDef *pUart)
+{
+  sHostUart *pModel = hostSim_FindUart(pUart);
+  uint32_t u32Tail = 0;
+  uint64_t u64Now = 0;
+  uint64_t u64Due = 0;
+
+  if (NULL == pModel)
+  {
+    return false;
+  }
+  if (0 != (pUart->ISR & USART_ISR_RXNE))
+  {
+    return true;
+  }
+  u32Tail = atomic_load_explicit(&pModel->u32Tail, memory_order_relaxed);
+  if (u32Tail == atomic_load_explicit(&pModel->u32Head, memory_order_acquire))
+  {
+    pModel->u64BurstNs = 0;   // idle line
+    return false;
+  }
+  u64Now = hostSim_Ns();
+  if (0 == pModel->u64BurstNs)
+  {
+    pModel->u64BurstNs = u64Now;
+    pModel->u64BurstBytes = 0;
+  }
+  u64Due = (((u64Now - pModel->u64BurstNs) * pModel->u32Rate) / HOST_SIM_NS_PER_S) + 1;
+  if (pModel->u64BurstBytes >= u64Due)
+  {
+    return false;
+  }
+  pUart->RDR = pModel->au8Rx[u32Tail % HOST_SIM_UART_RX_LEN];
+  atomic_store_explicit(&pModel->u32Tail, u32Tail + 1, memory_order_release);
+  pModel->u64BurstBytes++;
+  pUart->ISR |= USART_ISR_RXNE;
+  return true;
+}
+
+
+// RDR read, which clears RXNE
+static bool hostSim_UartRead(USART_TypeDef *pUart, uint8_t *pu8Data)
+{
+  if (0 == (pUart->ISR & USART_ISR_RXNE))
+  {
+    return false;
+  }
+  *pu8Data = (uint8_t)pUart->RDR;
+  pUart->ISR &= ~USART_ISR_RXNE;
+  return true;
+}
+
+
+static bool hostSim_IrqEnabled(IRQn_Type eIrq)
+{
+  return (0 <= eIrq) && (0 != (u32HostNvicEnabled & (1UL << (uint32_t)eIrq)));
+}
+
+
+// Interrupt context: TIM3 CH4 captures the edge, EXTI line 1 goes pending
+static void hostSim_PpsPoll(void)
+{
+  uint64_t u64EdgeNs = atomic_exchange(&u64HostPpsEdgeNs, 0);
+  uint64_t u64Now = 0;
+  uint64_t u64Back = 0;
+  TIM_TypeDef *pTim3 = NULL;
+
+  if (0 == u64EdgeNs)
+  {
+    return;
+  }
+  pTim3 = hostSim_TimSync((TIM_TypeDef *)TIM3_BASE);
+  u64Now = hostSim_Ns();
+  if (0 != (pTim3->CCER & TIM_CCER_CC4E))
+  {
+    // Counts since the edge, the capture is read within one TIM3 period
+    u64Back = (u64Now > u64EdgeNs) ? ((((u64Now - u64EdgeNs) * (HOST_SIM_CORE_CLOCK_HZ / 1000000UL)) / 1000ULL) /
+                                      ((uint64_t)pTim3->PSC + 1)) : 0;
+    pTim3->CCR4 = (uint32_t)(((uint64_t)pTim3->CNT + ((uint64_t)pTim3->ARR + 1) -
+                              (u64Back % ((uint64_t)pTim3->ARR + 1))) % ((uint64_t)pTim3->ARR + 1));
+    pTim3->SR |= TIM_SR_CC4IF;
+  }
+  if (0 != (EXTI->IMR & GPS_PPS_Pin))
+  {
+    EXTI->PR |= GPS_PPS_Pin;
+  }
+}
+
+
+static void hostSim_IwdgCheck(void)
+{
+  if ((true == HostIwdg.bRunning) && ((hostSim_Ns() - HostIwdg.u64RefreshNs) > HostIwdg.u64TimeoutNs))
+  {
+    hostSim_Reset("IWDG timeout");
+  }
+}
+
+
+static uint64_t hostSim_Cycles(void)
+{
+  return (hostSim_Ns() * (HOST_SIM_CORE_CLOCK_HZ / 1000000UL)) / 1000ULL;
+}
+
+
+static sHostTim *hostSim_FindTim(TIM_TypeDef *pTim)
+{
+  for (uint32_t u32Tim = 0; u32Tim < HOST_SIM_TIM_COUNT; u32Tim++)
+  {
+    if (pTim == HostTims[u32Tim].pTim)
+    {
+      return &HostTims[u32Tim];
+    }
+  }
+  return NULL;
+}
+
+
+static sHostUart *hostSim_FindUart(USART_TypeDef *pUart)
+{
+  for (uint32_t u32Uart = 0; u32Uart < HOST_SIM_UART_COUNT; u32Uart++)
+  {
+    if (pUart == HostUarts[u32Uart].pUart)
+    {
+      return &HostUarts[u32Uart];
+    }
+  }
+  return NULL;
+}
+
+
+static uint32_t hostSim_Bcd(uint32_t u32Value)
+{
+  return ((u32Value / 10) << 4) | (u32Value % 10);
+}
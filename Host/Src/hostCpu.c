@@ -0,0 +1,56 @@
+/*******************************************************************************
+* Filename: hostCpu.c
+* Developer: Jorge Yesid Rios Ortiz
+*******************************************************************************/
+
+#include <sched.h>
+#include "FreeRTOS.h"
+#include "hostSim.h"
+
+/*
+ * The core registers and instructions of cmsis_gcc.h of Host/Inc on the
+ * Posix port: PRIMASK is the tick signal mask and the tick handler is the
+ * only exception. Apart from halShim.c so the host tests can take the CPU
+ * without the peripheral model.
+ */
+
+
+uint32_t hostCpu_GetPrimask(void)
+{
+  return (pdFALSE != xPortInterruptsMasked()) ? 1 : 0;
+}
+
+
+void hostCpu_SetPrimask(uint32_t u32PriMask)
+{
+  if (0 != (u32PriMask & 1))
+  {
+    vPortDisableInterrupts();
+  }
+  else if (pdFALSE == xPortIsInsideInterrupt())
+  {
+    vPortEnableInterrupts();   // an ISR does not nest, the mask comes back when it returns
+  }
+}
+
+
+uint32_t hostCpu_GetIpsr(void)
+{
+  return (pdFALSE != xPortIsInsideInterrupt()) ? HOST_CPU_SYSTICK_EXCEPTION : 0;
+}
+
+
+// NVIC_SystemReset ends in a __NOP loop after the reset request
+void hostCpu_Nop(void)
+{
+  if (0 != (((SCB_Type *)SCB_BASE)->AIRCR & SCB_AIRCR_SYSRESETREQ_Msk))
+  {
+    hostSim_Reset("NVIC_SystemReset");
+  }
+}
+
+
+void hostCpu_Wfi(void)
+{
+  sched_yield();
+}
@@ -0,0 +1,389 @@
+/*******************************************************************************
+* Filename: hostMain.c
+* Developer: Jorge Yesid Rios Ortiz
+*******************************************************************************/
+
+#define _GNU_SOURCE
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include "main.h"
+#include "usart.h"
+#include "retarget.h"
+#include "FreeRTOS.h"
+#include "task.h"
+#include "hostSim.h"
+#include "hostPty.h"
+
+/*
+ * Linux host build of the firmware. The application, the kernel and the HAL
+ * handles are the ones of the target, see halShim.c for the peripherals:
+ * - the shell (USART3) reads stdin and writes stdout
+ * - the GPS (USART1) reads an NMEA file, or a pseudo terminal for a live
+ *   source or a GPS tool, and its commands go back to that terminal
+ *
+ *   F091-TestGps-host [-g file|pty] [-s scale] [-p] [-t seconds]
+ *
+ * An NMEA file is replayed with the time of its RMC and GGA sentences: an
+ * epoch starts when that time changes and waits for the difference divided
+ * by the scale, with the line running at scale times 9600 baud. Scale 0
+ * replays as fast as the UART interrupt takes the bytes, a load test where
+ * the gps task drops what it cannot decode in time. -p raises PPS at
+ * every epoch start, on a 1s grid only at scale 1 (ppsClock rejects other
+ * periods as HSI error). -t ends the run with a summary on stderr.
+ */
+
+#define HOST_MAIN_NMEA_LINE_LEN    128
+#define HOST_MAIN_GPS_RATE         960      // bytes per second at 9600 baud and scale 1
+#define HOST_MAIN_SHELL_LINE_MS    150      // above the 80ms the shell waits for the end of a line
+#define HOST_MAIN_EPOCH_MAX_S      10       // longer gaps in the file are replayed as 1s
+#define HOST_MAIN_FEED_RETRY_MS    1
+
+
+typedef struct
+{
+  const char *pGpsSource;
+  double dScale;
+  bool bPps;
+  uint32_t u32RunSeconds;
+} sHostOptions;
+
+
+static sHostOptions HostOptions = { NULL, 1.0, false, 0 };
+static int iHostGpsFd = -1;
+static volatile uint64_t u64HostGpsBytes = 0;
+static volatile uint64_t u64HostGpsEpochs = 0;
+static volatile uint64_t u64HostShellBytes = 0;
+
+int firmware_main(void);
+
+static bool hostMain_Options(int argc, char **argv);
+static bool hostMain_OpenPty(void);
+static void hostMain_Thread(void *(*pFunction)(void *));
+static void *hostMain_GpsFile(void *pArg);
+static void *hostMain_GpsPty(void *pArg);
+static void *hostMain_Shell(void *pArg);
+static void *hostMain_RunLimit(void *pArg);
+static void hostMain_Feed(USART_TypeDef *pUart, const uint8_t *pData, uint32_t u32Len);
+static bool hostMain_NmeaTime(const char *pLine, uint32_t *pu32Seconds);
+static void hostMain_SleepMs(uint64_t u64Ms);
+static void hostMain_SleepNs(uint64_t u64Ns);
+
+
+int main(int argc, char **argv)
+{
+  if (false == hostMain_Options(argc, argv))
+  {
+    fprintf(stderr, "usage: %s [-g file|pty] [-s scale] [-p] [-t seconds]\n", argv[0]);
+    return 1;
+  }
+  if (false == hostSim_Init())
+  {
+    return 1;
+  }
+  vPortSetInterruptHook(hostSim_Dispatch);
+
+  hostSim_UartSetRate(USART1, (0.0 == HostOptions.dScale) ? HOST_SIM_UART_UNLIMITED :
+                      (uint32_t)(HOST_MAIN_GPS_RATE * HostOptions.dScale));
+  if ((NULL != HostOptions.pGpsSource) && (0 == strcmp(HostOptions.pGpsSource, "pty")))
+  {
+    if (false == hostMain_OpenPty())
+    {
+      return 1;
+    }
+    hostMain_Thread(hostMain_GpsPty);
+  }
+  else if (NULL != HostOptions.pGpsSource)
+  {
+    iHostGpsFd = open(HostOptions.pGpsSource, O_RDONLY);
+    if (0 > iHostGpsFd)
+    {
+      perror(HostOptions.pGpsSource);
+      return 1;
+    }
+    hostMain_Thread(hostMain_GpsFile);
+  }
+  hostMain_Thread(hostMain_Shell);
+  if (0 != HostOptions.u32RunSeconds)
+  {
+    hostMain_Thread(hostMain_RunLimit);
+  }
+  return firmware_main();
+}
+
+
+// What configASSERT reports on the host instead of stopping the target
+void vAssertCalled(const char *pcFile, unsigned long ulLine)
+{
+  fprintf(stderr, "\nhost: assert %s:%lu\n", pcFile, ulLine);
+  abort();
+}
+
+
+/******************************************************************************
+ * retarget.c, which needs the newlib headers
+ ******************************************************************************/
+
+static UART_HandleTypeDef *pHostRetarget = NULL;
+
+
+void RetargetInit(UART_HandleTypeDef *huart)
+{
+  pHostRetarget = huart;
+}
+
+
+int _write(int fd, char *ptr, int len)
+{
+  if (((STDOUT_FILENO != fd) && (STDERR_FILENO != fd)) || (NULL == pHostRetarget))
+  {
+    errno = EBADF;
+    return -1;
+  }
+  if (HAL_OK != HAL_UART_Transmit(pHostRetarget, (uint8_t *)ptr, (uint16_t)len, HAL_MAX_DELAY))
+  {
+    errno = EIO;
+    return -1;
+  }
+  return len;
+}
+
+
+/******************************************************************************
+ * Local
+ ******************************************************************************/
+
+static bool hostMain_Options(int argc, char **argv)
+{
+  int iOption = 0;
+
+  while (-1 != (iOption = getopt(argc, argv, "g:s:pt:")))
+  {
+    switch (iOption)
+    {
+      case 'g':
+        HostOptions.pGpsSource = optarg;
+        break;
+      case 's':
+        HostOptions.dScale = atof(optarg);
+        if (0.0 > HostOptions.dScale)
+        {
+          return false;
+        }
+        break;
+      case 'p':
+        HostOptions.bPps = true;
+        break;
+      case 't':
+        HostOptions.u32RunSeconds = (uint32_t)strtoul(optarg, NULL, 10);
+        break;
+      default:
+        return false;
+    }
+  }
+  return (optind == argc);
+}
+
+
+static bool hostMain_OpenPty(void)
+{
+  iHostGpsFd = hostPty_Open();
+  if (0 > iHostGpsFd)
+  {
+    return false;
+  }
+  hostSim_UartSetTx(USART1, iHostGpsFd);
+  return true;
+}
+
+
+// Host threads never take the tick signal, it belongs to the running task
+static void hostMain_Thread(void *(*pFunction)(void *))
+{
+  pthread_t xThread;
+  sigset_t xAll;
+  sigset_t xPrevious;
+
+  sigfillset(&xAll);
+  pthread_sigmask(SIG_SETMASK, &xAll, &xPrevious);
+  if (0 != pthread_create(&xThread, NULL, pFunction, NULL))
+  {
+    fprintf(stderr, "host: no thread\n");
+    exit(1);
+  }
+  pthread_detach(xThread);
+  pthread_sigmask(SIG_SETMASK, &xPrevious, NULL);
+}
+
+
+static void *hostMain_GpsFile(void *pArg)
+{
+  FILE *pFile = fdopen(iHostGpsFd, "r");
+  char acLine[HOST_MAIN_NMEA_LINE_LEN];
+  uint32_t u32Epoch = 0;
+  uint32_t u32Time = 0;
+  bool bEpoch = false;
+  uint64_t u64EpochNs = 0;
+
+  (void)pArg;
+  while (NULL != fgets(acLine, sizeof(acLine), pFile))
+  {
+    if ((true == hostMain_NmeaTime(acLine, &u32Time)) && ((false == bEpoch) || (u32Time != u32Epoch)))
+    {
+      if ((true == bEpoch) && (0.0 != HostOptions.dScale))
+      {
+        uint32_t u32Gap = (u32Time + 86400 - u32Epoch) % 86400;
+        uint64_t u64Now = hostSim_Ns();
+
+        // Epochs on a fixed grid, so the PPS edges keep the file spacing exactly
+        u32Gap = ((0 == u32Gap) || (HOST_MAIN_EPOCH_MAX_S < u32Gap)) ? 1 : u32Gap;
+        u64EpochNs += (uint64_t)((u32Gap * 1e9) / HostOptions.dScale);
+        if (u64EpochNs > u64Now)
+        {
+          hostMain_SleepNs(u64EpochNs - u64Now);
+        }
+      }
+      else
+      {
+        u64EpochNs = hostSim_Ns();
+      }
+      u32Epoch = u32Time;
+      bEpoch = true;
+      u64HostGpsEpochs++;
+      if (true == HostOptions.bPps)
+      {
+        hostSim_PpsRequest(u64EpochNs);
+      }
+    }
+    hostMain_Feed(USART1, (const uint8_t *)acLine, (uint32_t)strlen(acLine));
+    u64HostGpsBytes += strlen(acLine);
+  }
+  fprintf(stderr, "host: end of %s, %llu epochs\n", HostOptions.pGpsSource, (unsigned long long)u64HostGpsEpochs);
+  fclose(pFile);
+  return NULL;
+}
+
+
+static void *hostMain_GpsPty(void *pArg)
+{
+  uint8_t au8Data[HOST_MAIN_NMEA_LINE_LEN];
+  ssize_t xRead = 0;
+
+  (void)pArg;
+  for (;;)
+  {
+    xRead = read(iHostGpsFd, au8Data, sizeof(au8Data));
+    if (0 < xRead)
+    {
+      hostMain_Feed(USART1, au8Data, (uint32_t)xRead);
+      u64HostGpsBytes += (uint64_t)xRead;
+    }
+    else if ((0 > xRead) && (EINTR != errno) && (EIO != errno))
+    {
+      perror("pty");
+      return NULL;
+    }
+    else if (0 >= xRead)
+    {
+      hostMain_SleepMs(10);   // EIO until the first open of the slave side by a tool
+    }
+  }
+  return NULL;
+}
+
+
+// A pause after every line, the shell takes a line when its input stops
+static void *hostMain_Shell(void *pArg)
+{
+  uint8_t u8Char = 0;
+
+  (void)pArg;
+  while (1 == read(STDIN_FILENO, &u8Char, 1))
+  {
+    hostMain_Feed(USART3, &u8Char, 1);
+    u64HostShellBytes++;
+    if ('\n' == u8Char)
+    {
+      hostMain_SleepMs(HOST_MAIN_SHELL_LINE_MS);
+    }
+  }
+  return NULL;
+}
+
+
+static void *hostMain_RunLimit(void *pArg)
+{
+  (void)pArg;
+  hostMain_SleepMs((uint64_t)HostOptions.u32RunSeconds * 1000ULL);
+  fprintf(stderr, "\nhost: %lus run, %lu ticks, GPS %llu bytes in %llu epochs, shell %llu bytes\n",
+          (unsigned long)HostOptions.u32RunSeconds, (unsigned long)xTaskGetTickCount(),
+          (unsigned long long)u64HostGpsBytes, (unsigned long long)u64HostGpsEpochs,
+          (unsigned long long)u64HostShellBytes);
+  exit(0);
+  return NULL;
+}
+
+
+static void hostMain_Feed(USART_TypeDef *pUart, const uint8_t *pData, uint32_t u32Len)
+{
+  uint32_t u32Taken = 0;
+
+  while (0 < u32Len)
+  {
+    u32Taken = hostSim_UartFeed(pUart, pData, u32Len);
+    pData += u32Taken;
+    u32Len -= u32Taken;
+    if (0 < u32Len)
+    {
+      hostMain_SleepMs(HOST_MAIN_FEED_RETRY_MS);
+    }
+  }
+}
+
+
+// hhmmss of an RMC or GGA sentence in seconds of the day
+static bool hostMain_NmeaTime(const char *pLine, uint32_t *pu32Seconds)
+{
+  const char *pTime = strchr(pLine, ',');
+  uint32_t au32Digits[6];
+
+  if (('$' != pLine[0]) || (NULL == pTime) || (6 > (pTime - pLine)) ||
+      ((0 != strncmp(pTime - 3, "RMC", 3)) && (0 != strncmp(pTime - 3, "GGA", 3))))
+  {
+    return false;
+  }
+  pTime++;
+  for (uint32_t u32Digit = 0; u32Digit < 6; u32Digit++)
+  {
+    if (('0' > pTime[u32Digit]) || ('9' < pTime[u32Digit]))
+    {
+      return false;
+    }
+    au32Digits[u32Digit] = (uint32_t)(pTime[u32Digit] - '0');
+  }
+  *pu32Seconds = (((au32Digits[0] * 10) + au32Digits[1]) * 3600) + (((au32Digits[2] * 10) + au32Digits[3]) * 60) +
+                 (au32Digits[4] * 10) + au32Digits[5];
+  return true;
+}
+
+
+static void hostMain_SleepMs(uint64_t u64Ms)
+{
+  hostMain_SleepNs(u64Ms * 1000000ULL);
+}
+
+
+static void hostMain_SleepNs(uint64_t u64Ns)
+{
+  struct timespec sDelay = { (time_t)(u64Ns / 1000000000ULL), (long)(u64Ns % 1000000000ULL) };
+
+  while ((0 != nanosleep(&sDelay, &sDelay)) && (EINTR == errno))
+  {
+  }
+}
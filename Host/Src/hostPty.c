@@ -0,0 +1,41 @@
+/*******************************************************************************
+* Filename: hostPty.c
+* Developer: Jorge Yesid Rios Ortiz
+*******************************************************************************/
+
+#define _GNU_SOURCE
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <termios.h>
+#include "hostPty.h"
+
+/*
+ * Apart from hostMain.c: the termios macros (CR1, CR2, ...) collide with the
+ * register names of the device header.
+ */
+
+
+// The slave stays open here, so the line survives a tool closing it. -1 on failure
+int hostPty_Open(void)
+{
+  struct termios sTermios;
+  int iMaster = posix_openpt(O_RDWR | O_NOCTTY);
+  int iSlave = -1;
+
+  if ((0 > iMaster) || (0 != grantpt(iMaster)) || (0 != unlockpt(iMaster)))
+  {
+    perror("pty");
+    return -1;
+  }
+  iSlave = open(ptsname(iMaster), O_RDWR | O_NOCTTY);
+  if ((0 > iSlave) || (0 != tcgetattr(iSlave, &sTermios)))
+  {
+    perror(ptsname(iMaster));
+    return -1;
+  }
+  cfmakeraw(&sTermios);
+  tcsetattr(iSlave, TCSANOW, &sTermios);
+  fprintf(stderr, "host: GPS on %s\n", ptsname(iMaster));
+  return iMaster;
+}
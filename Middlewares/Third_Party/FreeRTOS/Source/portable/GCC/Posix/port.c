@@ -0,0 +1,406 @@
+/*******************************************************************************
+* Filename: port.c
+* Developer: Jorge Yesid Rios Ortiz
+*******************************************************************************/
+
+/*-----------------------------------------------------------
+ * Implementation of functions defined in portable.h for the Posix port of
+ * the host build, see portmacro.h.
+ *
+ * A context switch hands the CPU from one thread to the next: the kernel picks
+ * the task, its thread is made runnable and the old one waits until it is
+ * picked again. Both sides of a switch run with SIGALRM masked, so the tick
+ * handler only ever runs in the thread of the running task and can switch
+ * from there, the way PendSV ends the SysTick handler on the target.
+ *----------------------------------------------------------*/
+
+#include <errno.h>
+#include <pthread.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/time.h>
+#include <time.h>
+
+/* Scheduler includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+
+#define portTICK_SIGNAL				SIGALRM
+#define portTHREAD_STACK_SIZE		( 256 * 1024 )
+
+/* Wall time of one tick. The host tests shorten it to run the kernel faster
+than real time, the firmware keeps the configured rate. */
+#ifndef portHOST_TICK_NS
+	#define portHOST_TICK_NS		( 1000000000ULL / configTICK_RATE_HZ )
+#endif
+
+/* Ticks handled by one interrupt when the tick was masked for a while; the
+tick count then catches up with the wall clock. */
+#define portMAX_CATCH_UP_TICKS		1000
+
+/* Lives at the top of the task stack, the TCB points to it. */
+typedef struct
+{
+	pthread_t xThread;
+	pthread_mutex_t xMutex;
+	pthread_cond_t xCond;
+	BaseType_t xRunnable;
+	TaskFunction_t pxCode;
+	void *pvParameters;
+	UBaseType_t uxCriticalNesting;
+} Thread_t;
+
+/* Critical nesting of the running task, saved in its Thread_t while it is
+switched out. */
+static volatile UBaseType_t uxCriticalNesting = 0;
+static volatile BaseType_t xSchedulerStarted = pdFALSE;
+static volatile BaseType_t xInsideInterrupt = pdFALSE;
+static volatile BaseType_t xSwitchRequired = pdFALSE;
+static void ( * volatile pxInterruptHook )( void ) = NULL;
+
+static sigset_t xTickSignal;
+static struct timespec xTickStart;
+static uint64_t ullTicksDone = 0;
+
+static pthread_mutex_t xEndMutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t xEndCond = PTHREAD_COND_INITIALIZER;
+static BaseType_t xSchedulerEnd = pdFALSE;
+
+static Thread_t *prvGetThread( TaskHandle_t xTask );
+static void prvResume( Thread_t *pxThread );
+static void prvSuspend( Thread_t *pxThread );
+static void prvSwitchContext( void );
+static void *prvThreadStart( void *pvParameters );
+static void prvTickSignal( int iSignal );
+static uint64_t prvElapsedTicks( void );
+static void prvTickSignalSetup( void );
+/*-----------------------------------------------------------*/
+
+StackType_t *pxPortInitialiseStack( StackType_t *pxTopOfStack, TaskFunction_t pxCode, void *pvParameters )
+{
+Thread_t *pxThread;
+pthread_attr_t xAttr;
+sigset_t xAllSignals, xSaved;
+
+	/* The stack itself is not used, the thread runs on its own. */
+	pxThread = ( Thread_t * ) ( ( ( portPOINTER_SIZE_TYPE ) ( pxTopOfStack + 1 ) - sizeof( Thread_t ) ) & ~( ( portPOINTER_SIZE_TYPE ) portBYTE_ALIGNMENT_MASK ) );
+	memset( pxThread, 0, sizeof( Thread_t ) );
+	pxThread->pxCode = pxCode;
+	pxThread->pvParameters = pvParameters;
+	pthread_mutex_init( &pxThread->xMutex, NULL );
+	pthread_cond_init( &pxThread->xCond, NULL );
+	prvTickSignalSetup();
+
+	/* Created with every signal masked, it must not take the tick while it
+	waits for its first turn. */
+	sigfillset( &xAllSignals );
+	pthread_sigmask( SIG_SETMASK, &xAllSignals, &xSaved );
+	pthread_attr_init( &xAttr );
+	pthread_attr_setstacksize( &xAttr, portTHREAD_STACK_SIZE );
+	pthread_attr_setdetachstate( &xAttr, PTHREAD_CREATE_DETACHED );
+	if( pthread_create( &pxThread->xThread, &xAttr, prvThreadStart, pxThread ) != 0 )
+	{
+		fprintf( stderr, "port: pthread_create failed\n" );
+		abort();
+	}
+	pthread_attr_destroy( &xAttr );
+	pthread_sigmask( SIG_SETMASK, &xSaved, NULL );
+
+	return ( StackType_t * ) pxThread;
+}
+/*-----------------------------------------------------------*/
+
+BaseType_t xPortStartScheduler( void )
+{
+struct sigaction xAction;
+struct itimerval xTimer;
+
+	prvTickSignalSetup();
+
+	/* The main thread never takes the tick, it only waits for the end. */
+	pthread_sigmask( SIG_BLOCK, &xTickSignal, NULL );
+
+	memset( &xAction, 0, sizeof( xAction ) );
+	xAction.sa_handler = prvTickSignal;
+	sigemptyset( &xAction.sa_mask );
+	xAction.sa_flags = SA_RESTART;
+	sigaction( portTICK_SIGNAL, &xAction, NULL );
+
+	clock_gettime( CLOCK_MONOTONIC, &xTickStart );
+	ullTicksDone = 0;
+	xTimer.it_interval.tv_sec = 0;
+	xTimer.it_interval.tv_usec = ( suseconds_t ) ( portHOST_TICK_NS / 1000ULL );
+	xTimer.it_value = xTimer.it_interval;
+	setitimer( ITIMER_REAL, &xTimer, NULL );
+
+	uxCriticalNesting = 0;
+	xSchedulerStarted = pdTRUE;
+	prvResume( prvGetThread( xTaskGetCurrentTaskHandle() ) );
+
+	pthread_mutex_lock( &xEndMutex );
+	while( xSchedulerEnd == pdFALSE )
+	{
+		pthread_cond_wait( &xEndCond, &xEndMutex );
+	}
+	pthread_mutex_unlock( &xEndMutex );
+
+	return pdFALSE;
+}
+/*-----------------------------------------------------------*/
+
+void vPortEndScheduler( void )
+{
+struct itimerval xTimer;
+
+	memset( &xTimer, 0, sizeof( xTimer ) );
+	setitimer( ITIMER_REAL, &xTimer, NULL );
+	pthread_mutex_lock( &xEndMutex );
+	xSchedulerEnd = pdTRUE;
+	pthread_cond_signal( &xEndCond );
+	pthread_mutex_unlock( &xEndMutex );
+}
+/*-----------------------------------------------------------*/
+
+void vPortYield( void )
+{
+sigset_t xSaved;
+
+	/* Before the start there is no running thread to hand over from, as on
+	the target the pended switch happens when the scheduler starts. */
+	if( xSchedulerStarted == pdFALSE )
+	{
+		return;
+	}
+	pthread_sigmask( SIG_BLOCK, &xTickSignal, &xSaved );
+	prvSwitchContext();
+	pthread_sigmask( SIG_SETMASK, &xSaved, NULL );
+}
+/*-----------------------------------------------------------*/
+
+void vPortYieldFromISR( void )
+{
+	if( xInsideInterrupt != pdFALSE )
+	{
+		/* Switched when the interrupt returns, like a pended PendSV. */
+		xSwitchRequired = pdTRUE;
+	}
+	else
+	{
+		vPortYield();
+	}
+}
+/*-----------------------------------------------------------*/
+
+void vPortEnterCritical( void )
+{
+	vPortDisableInterrupts();
+	uxCriticalNesting++;
+}
+/*-----------------------------------------------------------*/
+
+void vPortExitCritical( void )
+{
+	configASSERT( uxCriticalNesting );
+	uxCriticalNesting--;
+	if( uxCriticalNesting == 0 )
+	{
+		vPortEnableInterrupts();
+	}
+}
+/*-----------------------------------------------------------*/
+
+void vPortDisableInterrupts( void )
+{
+	prvTickSignalSetup();
+	pthread_sigmask( SIG_BLOCK, &xTickSignal, NULL );
+}
+/*-----------------------------------------------------------*/
+
+void vPortEnableInterrupts( void )
+{
+	prvTickSignalSetup();
+	pthread_sigmask( SIG_UNBLOCK, &xTickSignal, NULL );
+}
+/*-----------------------------------------------------------*/
+
+UBaseType_t uxPortSetInterruptMask( void )
+{
+UBaseType_t uxMasked = ( UBaseType_t ) xPortInterruptsMasked();
+
+	vPortDisableInterrupts();
+	return uxMasked;
+}
+/*-----------------------------------------------------------*/
+
+void vPortClearInterruptMask( UBaseType_t uxMask )
+{
+	if( uxMask == 0 )
+	{
+		vPortEnableInterrupts();
+	}
+}
+/*-----------------------------------------------------------*/
+
+BaseType_t xPortInterruptsMasked( void )
+{
+sigset_t xCurrent;
+
+	prvTickSignalSetup();
+	pthread_sigmask( SIG_BLOCK, NULL, &xCurrent );
+	return ( sigismember( &xCurrent, portTICK_SIGNAL ) == 1 ) ? pdTRUE : pdFALSE;
+}
+/*-----------------------------------------------------------*/
+
+BaseType_t xPortIsInsideInterrupt( void )
+{
+	return xInsideInterrupt;
+}
+/*-----------------------------------------------------------*/
+
+void vPortSetInterruptHook( void ( *pxHook )( void ) )
+{
+	pxInterruptHook = pxHook;
+}
+/*-----------------------------------------------------------*/
+
+void vPortSuppressTicksAndSleep( TickType_t xExpectedIdleTime )
+{
+sigset_t xSaved, xWait;
+
+	( void ) xExpectedIdleTime;
+
+	/* Checked with the tick masked and then released by sigsuspend() in one
+	step, an interrupt that readies a task in between is not slept through. */
+	pthread_sigmask( SIG_BLOCK, &xTickSignal, &xSaved );
+	if( eTaskConfirmSleepModeStatus() != eAbortSleep )
+	{
+		xWait = xSaved;
+		sigdelset( &xWait, portTICK_SIGNAL );
+		sigsuspend( &xWait );
+	}
+	pthread_sigmask( SIG_SETMASK, &xSaved, NULL );
+}
+/*-----------------------------------------------------------*/
+
+static Thread_t *prvGetThread( TaskHandle_t xTask )
+{
+	/* pxTopOfStack, the first member of the TCB, is what
+	pxPortInitialiseStack() returned. */
+	return *( Thread_t ** ) xTask;
+}
+/*-----------------------------------------------------------*/
+
+static void prvResume( Thread_t *pxThread )
+{
+	pthread_mutex_lock( &pxThread->xMutex );
+	pxThread->xRunnable = pdTRUE;
+	pthread_cond_signal( &pxThread->xCond );
+	pthread_mutex_unlock( &pxThread->xMutex );
+}
+/*-----------------------------------------------------------*/
+
+static void prvSuspend( Thread_t *pxThread )
+{
+	pthread_mutex_lock( &pxThread->xMutex );
+	while( pxThread->xRunnable == pdFALSE )
+	{
+		pthread_cond_wait( &pxThread->xCond, &pxThread->xMutex );
+	}
+	pxThread->xRunnable = pdFALSE;
+	pthread_mutex_unlock( &pxThread->xMutex );
+}
+/*-----------------------------------------------------------*/
+
+/* Called with the tick masked, from a task or from the tick handler. */
+static void prvSwitchContext( void )
+{
+Thread_t *pxOld = prvGetThread( xTaskGetCurrentTaskHandle() );
+Thread_t *pxNew;
+
+	vTaskSwitchContext();
+	pxNew = prvGetThread( xTaskGetCurrentTaskHandle() );
+	if( pxNew != pxOld )
+	{
+		pxOld->uxCriticalNesting = uxCriticalNesting;
+		prvResume( pxNew );
+		prvSuspend( pxOld );
+		uxCriticalNesting = pxOld->uxCriticalNesting;
+	}
+}
+/*-----------------------------------------------------------*/
+
+static void *prvThreadStart( void *pvParameters )
+{
+Thread_t *pxThread = ( Thread_t * ) pvParameters;
+
+	prvSuspend( pxThread );
+	uxCriticalNesting = 0;
+	vPortEnableInterrupts();
+	pxThread->pxCode( pxThread->pvParameters );
+
+	/* Tasks do not return. */
+	fprintf( stderr, "port: a task returned\n" );
+	abort();
+	return NULL;
+}
+/*-----------------------------------------------------------*/
+
+static void prvTickSignal( int iSignal )
+{
+int iErrno = errno;
+uint64_t ullDue;
+uint32_t ulCatchUp = 0;
+
+	( void ) iSignal;
+	xInsideInterrupt = pdTRUE;
+	if( pxInterruptHook != NULL )
+	{
+		pxInterruptHook();
+	}
+	ullDue = prvElapsedTicks();
+	while( ( ullTicksDone < ullDue ) && ( ulCatchUp < portMAX_CATCH_UP_TICKS ) )
+	{
+		if( xTaskIncrementTick() != pdFALSE )
+		{
+			xSwitchRequired = pdTRUE;
+		}
+		ullTicksDone++;
+		ulCatchUp++;
+	}
+	if( ullTicksDone < ullDue )
+	{
+		/* Stopped in a debugger or starved by the host, the lost time is
+		dropped rather than replayed. */
+		ullTicksDone = ullDue;
+	}
+	xInsideInterrupt = pdFALSE;
+
+	if( xSwitchRequired != pdFALSE )
+	{
+		xSwitchRequired = pdFALSE;
+		prvSwitchContext();
+	}
+	errno = iErrno;
+}
+/*-----------------------------------------------------------*/
+
+static uint64_t prvElapsedTicks( void )
+{
+struct timespec xNow;
+uint64_t ullNs;
+
+	clock_gettime( CLOCK_MONOTONIC, &xNow );
+	ullNs = ( uint64_t ) ( xNow.tv_sec - xTickStart.tv_sec ) * 1000000000ULL;
+	ullNs += ( uint64_t ) xNow.tv_nsec;
+	ullNs -= ( uint64_t ) xTickStart.tv_nsec;
+	return ullNs / portHOST_TICK_NS;
+}
+/*-----------------------------------------------------------*/
+
+static void prvTickSignalSetup( void )
+{
+	sigemptyset( &xTickSignal );
+	sigaddset( &xTickSignal, portTICK_SIGNAL );
+}
@@ -0,0 +1,127 @@
+/*******************************************************************************
+* Filename: testUtil.c
+* Developer: Jorge Yesid Rios Ortiz
+*******************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include "testUtil.h"
+#include "FreeRTOS.h"
+#include "task.h"
+
+/*
+ * Checks and the result line of the host tests, and what a kernel based test
+ * needs besides the kernel: the static memory of the idle and timer tasks and
+ * the hooks that freertos.c provides in the firmware. The output is plain
+ * stdio, printf-stdarg.c is not linked into the tests.
+ */
+
+#define TEST_UTIL_TASK_STACK    1024   // words, the host thread has its own stack
+
+static uint32_t u32TestChecks = 0;
+static uint32_t u32TestFailures = 0;
+static uint32_t u32TestSeed = 0x1234567;
+static const char *pTestName = NULL;
+static StaticTask_t TestTaskBuffer;
+static StackType_t TestTaskStack[TEST_UTIL_TASK_STACK];
+static StaticTask_t TestIdleTaskBuffer;
+static StackType_t TestIdleStack[configMINIMAL_STACK_SIZE];
+static StaticTask_t TestTimerTaskBuffer;
+static StackType_t TestTimerStack[configTIMER_TASK_STACK_DEPTH];
+
+
+void testUtil_Check(bool bPassed, const char *pCondition, const char *pFile, int iLine)
+{
+  u32TestChecks++;
+  if (false == bPassed)
+  {
+    u32TestFailures++;
+    fprintf(stderr, "%s:%d: check failed: %s\n", pFile, iLine, pCondition);
+  }
+}
+
+
+// Exit code of the test: 0 when every check passed
+int testUtil_Result(const char *pName)
+{
+  printf("%s: %s, %lu checks, %lu failed\n", (0 == u32TestFailures) ? "PASS" : "FAIL", pName,
+         (unsigned long)u32TestChecks, (unsigned long)u32TestFailures);
+  fflush(stdout);
+  return (0 == u32TestFailures) ? 0 : 1;
+}
+
+
+// CPU time of the calling thread
+uint64_t testUtil_CpuNs(void)
+{
+  struct timespec sNow;
+
+  clock_gettime(CLOCK_THREAD_CPUTIME_ID, &sNow);
+  return ((uint64_t)sNow.tv_sec * 1000000000ULL) + (uint64_t)sNow.tv_nsec;
+}
+
+
+// xorshift32, the same sequence on every run
+uint32_t testUtil_Random(void)
+{
+  u32TestSeed ^= u32TestSeed << 13;
+  u32TestSeed ^= u32TestSeed >> 17;
+  u32TestSeed ^= u32TestSeed << 5;
+  return u32TestSeed;
+}
+
+
+void testUtil_RunRtos(void (*pfTest)(void *), const char *pName)
+{
+  pTestName = pName;
+  xTaskCreateStatic(pfTest, "test", TEST_UTIL_TASK_STACK, NULL, tskIDLE_PRIORITY + 1, TestTaskStack,
+                    &TestTaskBuffer);
+  vTaskStartScheduler();
+}
+
+
+// From the test task: the result is the exit code of the process
+void testUtil_EndRtos(void)
+{
+  exit(testUtil_Result(pTestName));
+}
+
+
+void vApplicationGetIdleTaskMemory(StaticTask_t **ppxIdleTaskTCBBuffer, StackType_t **ppxIdleTaskStackBuffer,
+                                   uint32_t *pulIdleTaskStackSize)
+{
+  *ppxIdleTaskTCBBuffer = &TestIdleTaskBuffer;
+  *ppxIdleTaskStackBuffer = &TestIdleStack[0];
+  *pulIdleTaskStackSize = configMINIMAL_STACK_SIZE;
+}
+
+
+void vApplicationGetTimerTaskMemory(StaticTask_t **ppxTimerTaskTCBBuffer, StackType_t **ppxTimerTaskStackBuffer,
+                                    uint32_t *pulTimerTaskStackSize)
+{
+  *ppxTimerTaskTCBBuffer = &TestTimerTaskBuffer;
+  *ppxTimerTaskStackBuffer = &TestTimerStack[0];
+  *pulTimerTaskStackSize = configTIMER_TASK_STACK_DEPTH;
+}
+
+
+void vApplicationMallocFailedHook(void)
+{
+  fprintf(stderr, "malloc failed\n");
+  abort();
+}
+
+
+void vAssertCalled(const char *pcFile, unsigned long ulLine)
+{
+  fprintf(stderr, "assert %s:%lu\n", pcFile, ulLine);
+  abort();
+}
+
+
+void Error_Handler(void)
+{
+  fprintf(stderr, "Error_Handler\n");
+  abort();
+}
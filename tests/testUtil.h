@@ -0,0 +1,36 @@
+/*******************************************************************************
+* Filename: testUtil.h
+* Developer: Jorge Yesid Rios Ortiz
+*******************************************************************************/
+
+#ifndef __TEST_UTIL_H
+#define __TEST_UTIL_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+#include "stdint.h"
+#include "stdbool.h"
+
+
+// A failed check is reported and counted, the test goes on
+#define TEST_CHECK(cond)    testUtil_Check((cond), #cond, __FILE__, __LINE__)
+
+
+void testUtil_Check(bool bPassed, const char *pCondition, const char *pFile, int iLine);
+int testUtil_Result(const char *pName);
+uint64_t testUtil_CpuNs(void);
+uint32_t testUtil_Random(void);
+
+// Kernel based tests: main starts the scheduler with this task, which ends the process
+void testUtil_RunRtos(void (*pfTest)(void *), const char *pName);
+void testUtil_EndRtos(void);
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __TEST_UTIL_H */
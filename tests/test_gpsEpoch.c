@@ -0,0 +1,184 @@
+/*******************************************************************************
+* Filename: test_gpsEpoch.c
+* Developer: Jorge Yesid Rios Ortiz
+*******************************************************************************/
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <time.h>
+#if defined(__x86_64__)
+  #include <x86intrin.h>
+#endif
+#include "testUtil.h"
+#include "FreeRTOS.h"
+#include "task.h"
+#include "gps.h"
+
+/*
+ * The multiply and shift date conversions of gps.c against the C library
+ * (64 bit time_t): every day of the unsigned 32 bit Unix range, 1970-01-01 to
+ * 2106-02-07, at three times of the day, both ways, then random seconds. The
+ * benchmark gives the host time of one conversion; the figures of the M0 come
+ * from the `bench` shell command on the board.
+ * The time window of a new fix is checked at its ms boundaries, with the RTOS
+ * tick of the test.
+ */
+
+#define TEST_EPOCH_RANDOM        2000000
+#define TEST_EPOCH_BENCH_LOOPS  10000000
+#define TEST_EPOCH_LAST_DAY        49710   // 2106-02-07, the last day of a uint32_t epoch
+
+
+static TickType_t xTestTick = 0;
+extern sGpsData GpsData;
+extern bool gps_TimeInWindow(uint32_t u32Epoch);
+
+static const uint32_t TestTimesOfDay[] = { 0, 45296, GPS_SEC_PER_DAY - 1 };   // 00:00:00 12:34:56 23:59:59
+
+static bool test_Check(uint32_t u32Epoch);
+static void test_Bench(void);
+static void test_TimeWindow(void);
+
+
+int main(void)
+{
+  uint32_t u32Bad = 0;
+  uint32_t u32Epoch = 0;
+
+  for (uint32_t u32Day = 0; u32Day <= TEST_EPOCH_LAST_DAY; u32Day++)
+  {
+    for (uint32_t u32Tod = 0; u32Tod < (sizeof(TestTimesOfDay) / sizeof(TestTimesOfDay[0])); u32Tod++)
+    {
+      uint64_t u64Epoch = (uint64_t)u32Day * GPS_SEC_PER_DAY + TestTimesOfDay[u32Tod];
+
+      if (UINT32_MAX >= u64Epoch)
+      {
+        u32Bad += (false == test_Check((uint32_t)u64Epoch)) ? 1 : 0;
+      }
+    }
+  }
+  // The end of the range and the day that is not there
+  u32Bad += (false == test_Check(UINT32_MAX)) ? 1 : 0;
+  u32Bad += (false == test_Check((uint32_t)GPS_DAYS_2100_03_01 * GPS_SEC_PER_DAY - 1)) ? 1 : 0;
+  u32Bad += (false == test_Check((uint32_t)GPS_DAYS_2100_03_01 * GPS_SEC_PER_DAY)) ? 1 : 0;
+  TEST_CHECK(0 == u32Bad);
+  printf("gpsEpoch> %lu days x %u times of the day, %lu mismatches\n",
+         (unsigned long)(TEST_EPOCH_LAST_DAY + 1), (unsigned)(sizeof(TestTimesOfDay) / sizeof(TestTimesOfDay[0])),
+         (unsigned long)u32Bad);
+
+  u32Bad = 0;
+  for (uint32_t u32Loop = 0; u32Loop < TEST_EPOCH_RANDOM; u32Loop++)
+  {
+    u32Epoch = testUtil_Random();
+    u32Bad += (false == test_Check(u32Epoch)) ? 1 : 0;
+  }
+  TEST_CHECK(0 == u32Bad);
+  printf("gpsEpoch> %lu random seconds, %lu mismatches\n", (unsigned long)TEST_EPOCH_RANDOM,
+         (unsigned long)u32Bad);
+
+  test_Bench();
+  test_TimeWindow();
+  return testUtil_Result("gpsEpoch");
+}
+
+
+static bool test_Check(uint32_t u32Epoch)
+{
+  time_t xTime = (time_t)u32Epoch;
+  struct tm sTm;
+  sGpsDateTime sDateTime;
+  sGpsDateTime sOut;
+
+  gmtime_r(&xTime, &sTm);
+  sDateTime.sDate.u16Year = sTm.tm_year + 1900;
+  sDateTime.sDate.u8Month = sTm.tm_mon + 1;
+  sDateTime.sDate.u8Day = sTm.tm_mday;
+  sDateTime.sTime.u8Hour = sTm.tm_hour;
+  sDateTime.sTime.u8Min = sTm.tm_min;
+  sDateTime.sTime.u8Sec = sTm.tm_sec;
+  gps_EpochToDateTime(u32Epoch, &sOut);
+
+  if ((u32Epoch != gps_DateTimeToEpoch(&sDateTime)) ||
+      (sOut.sDate.u16Year != sDateTime.sDate.u16Year) || (sOut.sDate.u8Month != sDateTime.sDate.u8Month) ||
+      (sOut.sDate.u8Day != sDateTime.sDate.u8Day) || (sOut.sTime.u8Hour != sDateTime.sTime.u8Hour) ||
+      (sOut.sTime.u8Min != sDateTime.sTime.u8Min) || (sOut.sTime.u8Sec != sDateTime.sTime.u8Sec))
+  {
+    fprintf(stderr, "gpsEpoch> %lu: %04u-%02u-%02u %02u:%02u:%02u\n", (unsigned long)u32Epoch,
+            sOut.sDate.u16Year, sOut.sDate.u8Month, sOut.sDate.u8Day, sOut.sTime.u8Hour, sOut.sTime.u8Min,
+            sOut.sTime.u8Sec);
+    return false;
+  }
+  return true;
+}
+
+
+/*
+ * One conversion each way per loop over the whole range. Host CPU time, and
+ * the time stamp counter where there is one (not the cycles of the M0).
+ */
+static void test_Bench(void)
+{
+  sGpsDateTime sDateTime;
+  volatile uint32_t u32Sink = 0;
+  uint64_t u64Ns = 0;
+  uint64_t u64Cycles = 0;
+  uint32_t u32Epoch = 0;
+
+  u64Ns = testUtil_CpuNs();
+  #if defined(__x86_64__)
+    u64Cycles = __rdtsc();
+  #endif
+  for (uint32_t u32Loop = 0; u32Loop < TEST_EPOCH_BENCH_LOOPS; u32Loop++)
+  {
+    u32Epoch += 429467;   // steps through the range in 10000 loops
+    gps_EpochToDateTime(u32Epoch, &sDateTime);
+    u32Sink += gps_DateTimeToEpoch(&sDateTime);
+  }
+  #if defined(__x86_64__)
+    u64Cycles = __rdtsc() - u64Cycles;
+  #endif
+  u64Ns = testUtil_CpuNs() - u64Ns;
+  printf("gpsEpoch> host: %.1f ns, %.1f TSC cycles per conversion\n",
+         (double)u64Ns / (2.0 * TEST_EPOCH_BENCH_LOOPS), (double)u64Cycles / (2.0 * TEST_EPOCH_BENCH_LOOPS));
+}
+
+
+/*
+ * A fix may be ahead of the tick since the last one by 1/32 of it plus
+ * GPS_TIME_WINDOW_S. The tick is not rounded down to whole seconds first.
+ */
+static void test_TimeWindow(void)
+{
+  static const uint32_t TestElapsedMs[] = { 0, 999, 1999, 30000, 3600000 };
+  uint32_t u32Limit = 0;
+
+  for (uint32_t u32Case = 0; u32Case < (sizeof(TestElapsedMs) / sizeof(TestElapsedMs[0])); u32Case++)
+  {
+    GpsData.u32FixEpoch = 1700000000;
+    GpsData.u32FixTick = 0xFFFFF000;   // across the tick wrap
+    GpsData.u8TimeRejects = 0;
+    xTestTick = GpsData.u32FixTick + TestElapsedMs[u32Case];
+    u32Limit = (TestElapsedMs[u32Case] + (TestElapsedMs[u32Case] >> 5) + GPS_TIME_WINDOW_S * 1000) / 1000;
+
+    TEST_CHECK(true == gps_TimeInWindow(GpsData.u32FixEpoch + u32Limit));
+    TEST_CHECK(false == gps_TimeInWindow(GpsData.u32FixEpoch + u32Limit + 1));
+    TEST_CHECK(false == gps_TimeInWindow(GpsData.u32FixEpoch - 1));
+    TEST_CHECK(true == gps_TimeInWindow(GpsData.u32FixEpoch));
+  }
+  // 1999 ms: three seconds with the tick in whole seconds, four now
+  xTestTick = GpsData.u32FixTick + 1999;
+  TEST_CHECK(true == gps_TimeInWindow(GpsData.u32FixEpoch + 4));
+
+  // A time that really jumped is taken after GPS_TIME_WINDOW_REJECTS fixes
+  for (uint32_t u32Fix = 1; u32Fix < GPS_TIME_WINDOW_REJECTS; u32Fix++)
+  {
+    TEST_CHECK(false == gps_TimeInWindow(GpsData.u32FixEpoch + 3600));
+  }
+  TEST_CHECK(true == gps_TimeInWindow(GpsData.u32FixEpoch + 3600));
+}
+
+
+TickType_t xTaskGetTickCount(void)
+{
+  return xTestTick;
+}
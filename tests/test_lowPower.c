@@ -0,0 +1,218 @@
+/*******************************************************************************
+* Filename: test_lowPower.c
+* Developer: Jorge Yesid Rios Ortiz
+*******************************************************************************/
+
+#include <stdio.h>
+#include "testUtil.h"
+#include "lowPower.h"
+#include "WDT_Check.h"
+#include "tim.h"
+
+/*
+ * The arithmetic of the tickless idle of lowPower.c without the kernel: the
+ * RTC to kernel tick conversion over the whole WUT range and the LSI spread,
+ * the idle limit of the registered timers and the TIM2 LED helpers of
+ * WDT_Check.c. The last check runs the LED through simulated STOP periods,
+ * counter stopped, and compares its toggles with the ones of a free running
+ * timer.
+ */
+
+#define TEST_LP_US_MIN            750    // LSI at 53kHz
+#define TEST_LP_US_MAX           1250    // LSI at 32kHz
+#define TEST_LP_RTC_MAX         ((LOW_POWER_MAX_IDLE_MS * 1000) / TEST_LP_US_MIN)
+#define TEST_LP_BENCH_LOOPS   1000000
+#define TEST_LP_LED_PERIOD       1000    // ms, the permanent blink
+#define TEST_LP_SIM_MS         600000    // 10 minutes of idle
+
+
+extern sLowPower LowPower;
+extern uint32_t lowPower_TicksFromRtc(uint32_t u32RtcTicks, uint32_t u32UsPerRtcTick);
+extern uint32_t WDTCheck_LedMsToToggle(void);
+extern void WDTCheck_LedAdvance(uint32_t u32Ms);
+
+static TIM_TypeDef TestTim2;
+TIM_HandleTypeDef htim2 = { .Instance = &TestTim2 };
+static uint32_t u32TestMsToEvent = 0;
+
+static void test_TicksFromRtc(void);
+static void test_IdleLimit(void);
+static void test_Led(void);
+static uint32_t test_MsToEvent(void);
+static void test_Advance(uint32_t u32Ms);
+static uint32_t test_LedRun(uint32_t u32Ms);
+
+
+int main(void)
+{
+  test_TicksFromRtc();
+  test_IdleLimit();
+  test_Led();
+  return testUtil_Result("lowPower");
+}
+
+
+/*
+ * Every RTC count a STOP period can last, for every RTC tick length the
+ * calibration can measure. The kernel tick may only be short of the exact
+ * time by less than one tick, never ahead of it.
+ */
+static void test_TicksFromRtc(void)
+{
+  double dErrMax = 0;
+  double dErrSum = 0;
+  uint32_t u32Count = 0;
+  uint32_t u32Bad = 0;
+  volatile uint32_t u32Sink = 0;
+  uint64_t u64Ns = 0;
+
+  for (uint32_t u32Us = TEST_LP_US_MIN; u32Us <= TEST_LP_US_MAX; u32Us++)
+  {
+    for (uint32_t u32Rtc = 0; u32Rtc <= TEST_LP_RTC_MAX; u32Rtc++)
+    {
+      double dExact = ((double)u32Rtc * u32Us) / (1000000.0 / configTICK_RATE_HZ);
+      double dErr = dExact - lowPower_TicksFromRtc(u32Rtc, u32Us);
+
+      if ((0 > dErr) || (1 <= dErr))
+      {
+        u32Bad++;
+      }
+      dErrMax = (dErr > dErrMax) ? dErr : dErrMax;
+      dErrSum += dErr;
+      u32Count++;
+    }
+  }
+  TEST_CHECK(0 == u32Bad);
+
+  u64Ns = testUtil_CpuNs();
+  for (uint32_t u32Loop = 0; u32Loop < TEST_LP_BENCH_LOOPS; u32Loop++)
+  {
+    u32Sink += lowPower_TicksFromRtc(u32Loop & 0x3FFF, LOW_POWER_RTC_NOMINAL_US + (u32Loop & 0xFF));
+  }
+  u64Ns = testUtil_CpuNs() - u64Ns;
+
+  printf("lowPower> ticksFromRtc: %lu conversions, error max %.3f mean %.3f tick (behind), %.1f ns each\n",
+         (unsigned long)u32Count, dErrMax, dErrSum / u32Count, (double)u64Ns / TEST_LP_BENCH_LOOPS);
+}
+
+
+static void test_IdleLimit(void)
+{
+  // No timer: only the WUT range
+  TEST_CHECK(5 == lowPower_IdleLimit(5));
+  TEST_CHECK(LOW_POWER_MAX_IDLE_MS == lowPower_IdleLimit(portMAX_DELAY));
+
+  TEST_CHECK(false == lowPower_RegisterTimer(NULL, test_Advance));
+  TEST_CHECK(false == lowPower_RegisterTimer(test_MsToEvent, NULL));
+  TEST_CHECK(true == lowPower_RegisterTimer(test_MsToEvent, test_Advance));
+
+  u32TestMsToEvent = 300;
+  TEST_CHECK(300 == lowPower_IdleLimit(portMAX_DELAY));
+  TEST_CHECK(200 == lowPower_IdleLimit(200));
+  u32TestMsToEvent = 1;
+  TEST_CHECK(1 == lowPower_IdleLimit(5000));
+
+  // The second slot takes the LED, the table is then full
+  TEST_CHECK(true == lowPower_RegisterTimer(WDTCheck_LedMsToToggle, WDTCheck_LedAdvance));
+  TEST_CHECK(false == lowPower_RegisterTimer(test_MsToEvent, test_Advance));
+  LowPower.u8Timers = 0;
+}
+
+
+/*
+ * The idle task sleeps as long as the timers allow, the tick after the wake
+ * runs the last ms (the elapsed time is clamped to the limit - 1), then the
+ * counter advances by the time slept. The LED must toggle as often as a
+ * timer that never stops.
+ */
+static void test_Led(void)
+{
+  uint32_t u32Ms = 0;
+  uint32_t u32Toggles = 0;
+  uint32_t u32Stops = 0;
+  uint32_t u32Limit = 0;
+  uint32_t u32LastToggle = 0;
+  uint32_t u32PeriodMin = UINT32_MAX;
+  uint32_t u32PeriodMax = 0;
+  uint32_t u32Run = 0;
+
+  TestTim2.ARR = TEST_LP_LED_PERIOD - 1;
+  TestTim2.CNT = 0;
+  TEST_CHECK(TEST_LP_LED_PERIOD == WDTCheck_LedMsToToggle());
+  TestTim2.CNT = TEST_LP_LED_PERIOD - 1;
+  TEST_CHECK(1 == WDTCheck_LedMsToToggle());
+  TestTim2.CNT = 100;
+  WDTCheck_LedAdvance(400);
+  TEST_CHECK(500 == TestTim2.CNT);
+  WDTCheck_LedAdvance(TEST_LP_LED_PERIOD * 3);
+  TEST_CHECK((TEST_LP_LED_PERIOD - 1) == TestTim2.CNT);
+
+  TestTim2.CNT = 0;
+  TEST_CHECK(true == lowPower_RegisterTimer(WDTCheck_LedMsToToggle, WDTCheck_LedAdvance));
+  while (TEST_LP_SIM_MS > u32Ms)
+  {
+    // The kernel has nothing to do until the end of the WUT range
+    u32Limit = lowPower_IdleLimit(portMAX_DELAY);
+    TEST_CHECK(TEST_LP_LED_PERIOD >= u32Limit);
+    if (configEXPECTED_IDLE_TIME_BEFORE_SLEEP <= u32Limit)
+    {
+      WDTCheck_LedAdvance(u32Limit - 1);
+      u32Ms += u32Limit - 1;
+      u32Stops++;
+    }
+    u32Run = test_LedRun(1);
+    u32Ms++;
+    if (0 != u32Run)
+    {
+      u32Toggles++;
+      if (0 != u32LastToggle)
+      {
+        u32PeriodMin = ((u32Ms - u32LastToggle) < u32PeriodMin) ? (u32Ms - u32LastToggle) : u32PeriodMin;
+        u32PeriodMax = ((u32Ms - u32LastToggle) > u32PeriodMax) ? (u32Ms - u32LastToggle) : u32PeriodMax;
+      }
+      u32LastToggle = u32Ms;
+    }
+  }
+  LowPower.u8Timers = 0;
+
+  TEST_CHECK((TEST_LP_SIM_MS / TEST_LP_LED_PERIOD) == u32Toggles);
+  TEST_CHECK(TEST_LP_LED_PERIOD == u32PeriodMin);
+  TEST_CHECK(TEST_LP_LED_PERIOD == u32PeriodMax);
+  printf("lowPower> led: %lu toggles in %lu ms, period %lu..%lu ms, %lu stops\n",
+         (unsigned long)u32Toggles, (unsigned long)u32Ms, (unsigned long)u32PeriodMin,
+         (unsigned long)u32PeriodMax, (unsigned long)u32Stops);
+}
+
+
+static uint32_t test_MsToEvent(void)
+{
+  return u32TestMsToEvent;
+}
+
+
+static void test_Advance(uint32_t u32Ms)
+{
+  (void)u32Ms;
+}
+
+
+// TIM2 running: one count per ms, an update (toggle) after ARR
+static uint32_t test_LedRun(uint32_t u32Ms)
+{
+  uint32_t u32Updates = 0;
+
+  while (0 < u32Ms--)
+  {
+    if (TestTim2.CNT >= TestTim2.ARR)
+    {
+      TestTim2.CNT = 0;
+      u32Updates++;
+    }
+    else
+    {
+      TestTim2.CNT++;
+    }
+  }
+  return u32Updates;
+}
+
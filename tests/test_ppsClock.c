@@ -0,0 +1,209 @@
+/*******************************************************************************
+* Filename: test_ppsClock.c
+* Developer: Jorge Yesid Rios Ortiz
+*******************************************************************************/
+
+#include <math.h>
+#include <stdio.h>
+#include "testUtil.h"
+#include "ppsClock.h"
+
+/*
+ * Drift estimator of ppsClock.c without hardware: the PPS edges of a receiver
+ * are generated on a TIM3 timebase that runs off nominal by the HSI error,
+ * each timestamp moved by a uniform jitter. The estimate must lock within
+ * PPS_CLOCK_LOCK_COUNT intervals and then stay close to the real ticks per
+ * second; missed edges are bridged, glitches and a lost PPS drop the lock.
+ * Errors are printed in ppb of one second (1 tick = 1000 ppb).
+ */
+
+#define TEST_PPS_SECONDS        600     // edges per run after the lock
+#define TEST_PPS_SETTLE          40     // intervals for the filter (1/8) to settle
+
+
+typedef struct
+{
+  double dTicksPerSec;      // real TIM3 ticks between two edges
+  double dEdge;             // real time of the next edge, in ticks
+  uint32_t u32Jitter;       // +- ticks on each timestamp
+} sTestPps;
+
+
+static void test_Jitter(double dPpm, uint32_t u32Jitter, double dMaxPpb);
+static void test_Gaps(void);
+static void test_Glitches(void);
+static void test_Wrap(void);
+static uint32_t test_NextEdge(sTestPps *pPps, uint32_t u32Skip);
+static double test_ErrorPpb(const sPpsClockEstimator *pEst, const sTestPps *pPps);
+
+
+int main(void)
+{
+  // HSI within +-1%, receivers from +-1 tick (TIM3 resolution) to +-10 ticks
+  test_Jitter(0.0, 0, 1000);
+  test_Jitter(7300.4, 0, 1000);
+  test_Jitter(-15000.7, 1, 1000);
+  test_Jitter(7300.4, 5, 2000);
+  test_Jitter(19000.2, 10, 4000);
+  test_Gaps();
+  test_Glitches();
+  test_Wrap();
+  return testUtil_Result("ppsClock");
+}
+
+
+static void test_Jitter(double dPpm, uint32_t u32Jitter, double dMaxPpb)
+{
+  sPpsClockEstimator sEst;
+  sTestPps sPps = { .dTicksPerSec = PPS_CLOCK_NOMINAL_HZ * (1 + dPpm / 1000000), .dEdge = 12345,
+                    .u32Jitter = u32Jitter };
+  uint32_t u32Lock = 0;
+  double dErr = 0;
+  double dErrSum = 0;
+  double dErrSq = 0;
+  double dErrMax = 0;
+  uint32_t u32Rejected = 0;
+
+  ppsClock_EstimatorReset(&sEst);
+  sEst.u32Rejected = 0;
+  sEst.u32Intervals = 0;
+  while ((false == sEst.bLocked) && (u32Lock < 10))
+  {
+    ppsClock_EstimatorUpdate(&sEst, test_NextEdge(&sPps, 0));
+    u32Lock++;
+  }
+  // The first edge only starts the interval
+  TEST_CHECK((PPS_CLOCK_LOCK_COUNT + 1) == u32Lock);
+
+  for (uint32_t u32Sec = 0; u32Sec < (TEST_PPS_SETTLE + TEST_PPS_SECONDS); u32Sec++)
+  {
+    ppsClock_EstimatorUpdate(&sEst, test_NextEdge(&sPps, 0));
+    if (TEST_PPS_SETTLE <= u32Sec)
+    {
+      dErr = test_ErrorPpb(&sEst, &sPps);
+      dErrSum += dErr;
+      dErrSq += dErr * dErr;
+      dErrMax = (fabs(dErr) > dErrMax) ? fabs(dErr) : dErrMax;
+    }
+  }
+  u32Rejected = sEst.u32Rejected;
+  TEST_CHECK(true == sEst.bLocked);
+  // An interval moves by up to twice the jitter, plus the error of the estimate
+  TEST_CHECK((((2 * u32Jitter) + 2) < PPS_CLOCK_JITTER_TICKS) ? (0 == u32Rejected) : (u32Rejected < 10));
+  TEST_CHECK(dMaxPpb > dErrMax);
+  printf("ppsClock> %+9.1f ppm jitter +-%2lu: lock after %lu edges, %lu rejected, error mean %+5.0f rms %4.0f "
+         "max %4.0f ppb\n", dPpm, (unsigned long)u32Jitter, (unsigned long)u32Lock, (unsigned long)u32Rejected,
+         dErrSum / TEST_PPS_SECONDS, sqrt(dErrSq / TEST_PPS_SECONDS), dErrMax);
+}
+
+
+// Up to PPS_CLOCK_MAX_GAP seconds are bridged, one more is a new start
+static void test_Gaps(void)
+{
+  sPpsClockEstimator sEst;
+  sTestPps sPps = { .dTicksPerSec = PPS_CLOCK_NOMINAL_HZ * 1.0042, .dEdge = 0, .u32Jitter = 2 };
+
+  ppsClock_EstimatorReset(&sEst);
+  for (uint32_t u32Sec = 0; u32Sec < TEST_PPS_SETTLE; u32Sec++)
+  {
+    ppsClock_EstimatorUpdate(&sEst, test_NextEdge(&sPps, 0));
+  }
+  TEST_CHECK(true == sEst.bLocked);
+  for (uint32_t u32Skip = 1; u32Skip < PPS_CLOCK_MAX_GAP; u32Skip++)
+  {
+    TEST_CHECK(true == ppsClock_EstimatorUpdate(&sEst, test_NextEdge(&sPps, u32Skip)));
+    TEST_CHECK(true == sEst.bLocked);
+    TEST_CHECK(1000 > fabs(test_ErrorPpb(&sEst, &sPps)));
+  }
+  TEST_CHECK(false == ppsClock_EstimatorUpdate(&sEst, test_NextEdge(&sPps, PPS_CLOCK_MAX_GAP)));
+  TEST_CHECK(false == sEst.bLocked);
+}
+
+
+/*
+ * A late timestamp is out of the window twice (it ends one interval and
+ * starts the next); the lock survives it. Outliers in a row drop it.
+ */
+static void test_Glitches(void)
+{
+  sPpsClockEstimator sEst;
+  sTestPps sPps = { .dTicksPerSec = PPS_CLOCK_NOMINAL_HZ * 0.9973, .dEdge = 0, .u32Jitter = 2 };
+  uint32_t u32Edge = 0;
+  uint32_t u32Rejected = 0;
+
+  ppsClock_EstimatorReset(&sEst);
+  for (uint32_t u32Sec = 0; u32Sec < TEST_PPS_SETTLE; u32Sec++)
+  {
+    ppsClock_EstimatorUpdate(&sEst, test_NextEdge(&sPps, 0));
+  }
+  u32Rejected = sEst.u32Rejected;
+
+  // A timestamp 30 ticks late: both of its intervals are rejected, the lock stays
+  u32Edge = test_NextEdge(&sPps, 0);
+  TEST_CHECK(false == ppsClock_EstimatorUpdate(&sEst, u32Edge + 30));
+  TEST_CHECK(true == sEst.bLocked);
+  TEST_CHECK(false == ppsClock_EstimatorUpdate(&sEst, test_NextEdge(&sPps, 0)));
+  TEST_CHECK(true == sEst.bLocked);
+  TEST_CHECK(true == ppsClock_EstimatorUpdate(&sEst, test_NextEdge(&sPps, 0)));
+  TEST_CHECK((u32Rejected + 2) == sEst.u32Rejected);
+  TEST_CHECK(1000 > fabs(test_ErrorPpb(&sEst, &sPps)));
+
+  // Jitter beyond PPS_CLOCK_JITTER_TICKS on every edge: the lock is lost
+  sPps.u32Jitter = PPS_CLOCK_JITTER_TICKS * 10;
+  for (uint32_t u32Sec = 0; (u32Sec < 20) && (true == sEst.bLocked); u32Sec++)
+  {
+    ppsClock_EstimatorUpdate(&sEst, test_NextEdge(&sPps, 0));
+  }
+  TEST_CHECK(false == sEst.bLocked);
+
+  // A timer that is 3% off is not a PPS
+  sPps.dTicksPerSec = PPS_CLOCK_NOMINAL_HZ * 1.03;
+  sPps.u32Jitter = 0;
+  ppsClock_EstimatorReset(&sEst);
+  for (uint32_t u32Sec = 0; u32Sec < TEST_PPS_SETTLE; u32Sec++)
+  {
+    TEST_CHECK(false == ppsClock_EstimatorUpdate(&sEst, test_NextEdge(&sPps, 0)));
+  }
+  TEST_CHECK(false == sEst.bLocked);
+}
+
+
+// The 32 bit timestamp wraps every 71 minutes without a hiccup
+static void test_Wrap(void)
+{
+  sPpsClockEstimator sEst;
+  sTestPps sPps = { .dTicksPerSec = PPS_CLOCK_NOMINAL_HZ * 1.0011, .dEdge = 4294967296.0 - 20.5e6,
+                    .u32Jitter = 3 };
+  uint32_t u32Accepted = 0;
+
+  ppsClock_EstimatorReset(&sEst);
+  for (uint32_t u32Sec = 0; u32Sec < 40; u32Sec++)
+  {
+    u32Accepted += (true == ppsClock_EstimatorUpdate(&sEst, test_NextEdge(&sPps, 0))) ? 1 : 0;
+  }
+  TEST_CHECK(39 == u32Accepted);
+  TEST_CHECK(true == sEst.bLocked);
+  TEST_CHECK(1000 > fabs(test_ErrorPpb(&sEst, &sPps)));
+}
+
+
+// Timestamp of the edge after u32Skip missed ones, as TIM3 captures it
+static uint32_t test_NextEdge(sTestPps *pPps, uint32_t u32Skip)
+{
+  double dStamp = 0;
+
+  pPps->dEdge += pPps->dTicksPerSec * u32Skip;
+  dStamp = pPps->dEdge;
+  if (0 != pPps->u32Jitter)
+  {
+    dStamp += (double)(testUtil_Random() % (2 * pPps->u32Jitter + 1)) - pPps->u32Jitter;
+  }
+  pPps->dEdge += pPps->dTicksPerSec;
+  return (uint32_t)(uint64_t)floor(dStamp);
+}
+
+
+static double test_ErrorPpb(const sPpsClockEstimator *pEst, const sTestPps *pPps)
+{
+  return ((pEst->u32TicksPerSecQ8 / 256.0) - pPps->dTicksPerSec) * 1000000000.0 / pPps->dTicksPerSec;
+}
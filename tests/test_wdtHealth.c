@@ -0,0 +1,326 @@
+/*******************************************************************************
+* Filename: test_wdtHealth.c
+* Developer: Jorge Yesid Rios Ortiz
+*******************************************************************************/
+
+#include <pthread.h>
+#include <stdio.h>
+#include <time.h>
+#include "testUtil.h"
+#include "WDT_Check.h"
+#include "lowPower.h"
+#include "tim.h"
+#include "trace.h"
+
+/*
+ * Health rounds of WDT_Check.c on the host kernel, built once per value of
+ * DEBUG_WDT_CHECK_ACTIVE. Three worker tasks answer the requests until one of
+ * them hangs at a random point of the round period; the test measures how long
+ * the watchdog takes to name it. Without the IWDG the rounds must go on once
+ * the worker is back, with it the refreshes must stop.
+ * The kernel runs 10 times faster than real time (portHOST_TICK_NS), times
+ * below are in kernel ticks (ms).
+ */
+
+#define TEST_WDT_WORKERS          3
+#define TEST_WDT_HUNG_WORKER      1
+#define TEST_WDT_TRIALS           ((1 == DEBUG_WDT_CHECK_ACTIVE) ? 1 : 5)
+#define TEST_WDT_HEALTHY_ROUNDS   3
+#define TEST_WDT_POLL_MS          10
+#define TEST_WDT_BLINK_MS         1000    // window of the wakeup count at a fast blink
+#define TEST_WDT_LATENCY_MAX      (WDT_CHECK_HEALTH_PERIOD + WDT_CHECK_HEALTH_DEADLINE + WDT_CHECK_REFRESH_PERIOD + TEST_WDT_POLL_MS)
+
+
+typedef struct
+{
+  TaskHandle_t xTask;
+  uint8_t u8WdtId;
+  volatile bool bHung;
+  StaticTask_t xBuffer;
+  StackType_t xStack[configMINIMAL_STACK_SIZE * 4];
+} sTestWorker;
+
+
+static sTestWorker TestWorkers[TEST_WDT_WORKERS];
+static volatile uint32_t u32TestRefreshes = 0;
+static volatile uint32_t u32TestIwdgInits = 0;
+static volatile uint32_t u32TestSwitches = 0;
+static volatile uint32_t u32TestWdtWakeups = 0;
+static clockid_t xTestWdtClock;
+static volatile bool bTestWdtClock = false;
+static TIM_TypeDef TestTim2;
+
+extern sWDTCheck_Health WdtHealth;
+extern TaskHandle_t WDTCheck_TaskHandle;
+TIM_HandleTypeDef htim2 = { .Instance = &TestTim2 };
+IWDG_HandleTypeDef hiwdg;   // iwdg.c is not linked
+
+static void test_Worker(void *pvParameters);
+static void test_Request0(void);
+static void test_Request1(void);
+static void test_Request2(void);
+static void test_Run(void *pvParameters);
+static bool test_WaitRounds(uint32_t u32Rounds, uint32_t u32TimeoutMs);
+static uint32_t test_WdtWakeups(uint32_t u32WindowMs);
+static uint64_t test_WdtCpuNs(void);
+
+static const pfWDTCheck_HealthRequest TestRequests[TEST_WDT_WORKERS] = { test_Request0, test_Request1, test_Request2 };
+
+
+int main(void)
+{
+  for (uint8_t u8Worker = 0; u8Worker < TEST_WDT_WORKERS; u8Worker++)
+  {
+    TestWorkers[u8Worker].u8WdtId = WDTCheck_RegisterTask(TestRequests[u8Worker]);
+    TestWorkers[u8Worker].xTask = xTaskCreateStatic(test_Worker, "worker", configMINIMAL_STACK_SIZE * 4,
+                                                    &TestWorkers[u8Worker], tskIDLE_PRIORITY + 1,
+                                                    TestWorkers[u8Worker].xStack, &TestWorkers[u8Worker].xBuffer);
+  }
+  testUtil_RunRtos(test_Run, (1 == DEBUG_WDT_CHECK_ACTIVE) ? "wdtHealth (IWDG)" : "wdtHealth");
+  return 1;
+}
+
+
+static void test_Run(void *pvParameters)
+{
+  uint32_t u32Rounds = 0;
+  uint64_t u64Cpu = 0;
+  uint32_t u32Switches = 0;
+  uint32_t u32AnswerTicks = 0;
+  uint32_t u32WakeupsSlow = 0;
+  uint32_t u32WakeupsFast = 0;
+  uint32_t u32LatencyMin = UINT32_MAX;
+  uint32_t u32LatencyMax = 0;
+  uint32_t u32LatencySum = 0;
+
+  (void)pvParameters;
+  WDTCheck_InitFW();
+
+  // Healthy: every round answered at once, the cost of one round period
+  TEST_CHECK(true == test_WaitRounds(1, WDT_CHECK_HEALTH_PERIOD * 2));
+  u32Rounds = WdtHealth.u32Rounds;
+  u64Cpu = test_WdtCpuNs();
+  u32Switches = u32TestSwitches;
+  TEST_CHECK(true == test_WaitRounds(u32Rounds + TEST_WDT_HEALTHY_ROUNDS, WDT_CHECK_HEALTH_PERIOD * 5));
+  u64Cpu = (test_WdtCpuNs() - u64Cpu) / TEST_WDT_HEALTHY_ROUNDS;
+  u32Switches = (u32TestSwitches - u32Switches) / TEST_WDT_HEALTHY_ROUNDS;
+  TEST_CHECK(WdtHealth.uxRegistered == WdtHealth.uxLastAnswered);
+  u32AnswerTicks = WdtHealth.u32LastRoundTicks;
+  TEST_CHECK(2 >= u32AnswerTicks);
+  TEST_CHECK(DEBUG_WDT_CHECK_ACTIVE == u32TestIwdgInits);
+  TEST_CHECK((1 == DEBUG_WDT_CHECK_ACTIVE) == (0 != u32TestRefreshes));
+
+  // Wakeups of the wdt task per second at the idle blink and at the fastest proximity blink
+  u32WakeupsSlow = test_WdtWakeups(WDT_CHECK_HEALTH_PERIOD);
+  WDTCheck_Period(true, WDT_CHECK_PERIOD_20, WDT_CHECK_DEFAULT_TIMES);
+  vTaskDelay(WDT_CHECK_PERIOD);   // the new period takes over
+  u32WakeupsFast = test_WdtWakeups(TEST_WDT_BLINK_MS);
+  WDTCheck_Period(true, WDT_CHECK_PERIOD, WDT_CHECK_DEFAULT_TIMES);
+
+  for (uint32_t u32Trial = 0; u32Trial < TEST_WDT_TRIALS; u32Trial++)
+  {
+    TickType_t xHang = 0;
+    uint32_t u32Latency = 0;
+
+    // Hang anywhere in the period after a round
+    TEST_CHECK(true == test_WaitRounds(WdtHealth.u32Rounds + 1, WDT_CHECK_HEALTH_PERIOD * 2));
+    vTaskDelay(testUtil_Random() % WDT_CHECK_HEALTH_PERIOD);
+    xHang = xTaskGetTickCount();
+    TestWorkers[TEST_WDT_HUNG_WORKER].bHung = true;
+    while ((WdtHealth.uxRegistered == WdtHealth.uxLastAnswered) &&
+           ((xTaskGetTickCount() - xHang) < (TEST_WDT_LATENCY_MAX * 2)))
+    {
+      vTaskDelay(TEST_WDT_POLL_MS);
+    }
+    u32Latency = xTaskGetTickCount() - xHang;
+    TEST_CHECK(WDT_CHECK_HEALTH_DEADLINE <= u32Latency);
+    TEST_CHECK(TEST_WDT_LATENCY_MAX >= u32Latency);
+    TEST_CHECK(((EventBits_t)1 << TestWorkers[TEST_WDT_HUNG_WORKER].u8WdtId) ==
+               (WdtHealth.uxRegistered & ~WdtHealth.uxLastAnswered));
+    u32LatencyMin = (u32Latency < u32LatencyMin) ? u32Latency : u32LatencyMin;
+    u32LatencyMax = (u32Latency > u32LatencyMax) ? u32Latency : u32LatencyMax;
+    u32LatencySum += u32Latency;
+    TestWorkers[TEST_WDT_HUNG_WORKER].bHung = false;
+
+    #if 1==DEBUG_WDT_CHECK_ACTIVE
+    {
+      // The IWDG is left to expire: no refresh, no more rounds
+      uint32_t u32Refreshes = u32TestRefreshes;
+      uint32_t u32After = WdtHealth.u32Rounds;
+
+      vTaskDelay(WDT_CHECK_HEALTH_PERIOD * 2);
+      TEST_CHECK(u32Refreshes == u32TestRefreshes);
+      TEST_CHECK(u32After == WdtHealth.u32Rounds);
+    }
+    #else
+      // Back to healthy rounds without a reset
+      TEST_CHECK(true == test_WaitRounds(WdtHealth.u32Rounds + 2, WDT_CHECK_HEALTH_PERIOD * 3));
+      TEST_CHECK(WdtHealth.uxRegistered == WdtHealth.uxLastAnswered);
+    #endif
+  }
+
+  printf("WDT> healthy round: %lu ms to answer, %lu switches to the wdt and worker tasks and %llu us host CPU of the wdt task per "
+         "%u ms period\n", (unsigned long)u32AnswerTicks, (unsigned long)u32Switches,
+         (unsigned long long)(u64Cpu / 1000), WDT_CHECK_HEALTH_PERIOD);
+  printf("WDT> wdt task wakeups: %lu per s with the LED at %u ms, %lu per s at %u ms\n",
+         (unsigned long)u32WakeupsSlow, WDT_CHECK_PERIOD, (unsigned long)u32WakeupsFast, WDT_CHECK_PERIOD_20);
+  printf("WDT> hang detected after min %lu / mean %lu / max %lu ms over %u trials (bound %u ms)\n",
+         (unsigned long)u32LatencyMin, (unsigned long)(u32LatencySum / TEST_WDT_TRIALS),
+         (unsigned long)u32LatencyMax, TEST_WDT_TRIALS, TEST_WDT_LATENCY_MAX);
+  testUtil_EndRtos();
+}
+
+
+static void test_Worker(void *pvParameters)
+{
+  sTestWorker *pWorker = (sTestWorker *)pvParameters;
+
+  for (;;)
+  {
+    ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+    if (false == pWorker->bHung)
+    {
+      WDTCheck_HealthResponse(pWorker->u8WdtId);
+    }
+  }
+}
+
+
+// Requests run in the wdt task, which also names its thread clock
+static void test_Request0(void)
+{
+  if (false == bTestWdtClock)
+  {
+    pthread_getcpuclockid(pthread_self(), &xTestWdtClock);
+    bTestWdtClock = true;
+  }
+  xTaskNotifyGive(TestWorkers[0].xTask);
+}
+
+
+static void test_Request1(void)
+{
+  xTaskNotifyGive(TestWorkers[1].xTask);
+}
+
+
+static void test_Request2(void)
+{
+  xTaskNotifyGive(TestWorkers[2].xTask);
+}
+
+
+static bool test_WaitRounds(uint32_t u32Rounds, uint32_t u32TimeoutMs)
+{
+  TickType_t xStart = xTaskGetTickCount();
+
+  while (WdtHealth.u32Rounds < u32Rounds)
+  {
+    if ((xTaskGetTickCount() - xStart) >= pdMS_TO_TICKS(u32TimeoutMs))
+    {
+      return false;
+    }
+    vTaskDelay(TEST_WDT_POLL_MS);
+  }
+  return true;
+}
+
+
+// Switches into the wdt task over the window, per second of kernel time
+static uint32_t test_WdtWakeups(uint32_t u32WindowMs)
+{
+  uint32_t u32Wakeups = u32TestWdtWakeups;
+
+  vTaskDelay(pdMS_TO_TICKS(u32WindowMs));
+  return (u32TestWdtWakeups - u32Wakeups) * 1000 / u32WindowMs;
+}
+
+
+static uint64_t test_WdtCpuNs(void)
+{
+  struct timespec sNow = { 0, 0 };
+
+  if (true == bTestWdtClock)
+  {
+    clock_gettime(xTestWdtClock, &sNow);
+  }
+  return ((uint64_t)sNow.tv_sec * 1000000000ULL) + (uint64_t)sNow.tv_nsec;
+}
+
+
+/******************************************************************************
+ * What the wdt task uses besides the kernel
+ ******************************************************************************/
+
+HAL_StatusTypeDef HAL_TIM_OC_Start(TIM_HandleTypeDef *htim, uint32_t Channel)
+{
+  (void)htim;
+  (void)Channel;
+  return HAL_OK;
+}
+
+
+void lowPower_Calibrate(void)
+{
+}
+
+
+void lowPower_StopInhibit(bool bInhibit)
+{
+  (void)bInhibit;
+}
+
+
+bool lowPower_RegisterTimer(pfLowPowerMsToEvent pfMsToEvent, pfLowPowerAdvance pfAdvance)
+{
+  (void)pfMsToEvent;
+  (void)pfAdvance;
+  return true;
+}
+
+
+void MX_IWDG_Init(void)
+{
+  u32TestIwdgInits++;
+}
+
+
+HAL_StatusTypeDef HAL_IWDG_Refresh(IWDG_HandleTypeDef *hiwdg)
+{
+  (void)hiwdg;
+  u32TestRefreshes++;
+  return HAL_OK;
+}
+
+
+// Built with TRACE_ACTIVE: the kernel reports every switch, the ones of the round are counted
+void trace_Record(uint8_t u8Type, uint8_t u8Id, uint16_t u16Param)
+{
+  TaskHandle_t xTask = xTaskGetCurrentTaskHandle();
+
+  (void)u8Id;
+  (void)u16Param;
+  if (TRACE_EVT_TASK_IN != u8Type)
+  {
+    return;
+  }
+  if (xTask == WDTCheck_TaskHandle)
+  {
+    u32TestSwitches++;
+    u32TestWdtWakeups++;
+  }
+  for (uint8_t u8Worker = 0; u8Worker < TEST_WDT_WORKERS; u8Worker++)
+  {
+    if (xTask == TestWorkers[u8Worker].xTask)
+    {
+      u32TestSwitches++;
+    }
+  }
+}
+
+
+void trace_TaskCreated(uint32_t u32Number, const char *pName)
+{
+  (void)u32Number;
+  (void)pName;
+}
@@ -0,0 +1,139 @@
+#!/usr/bin/env python3
+"""Per-module RAM budget from a GNU ld map file.
+
+Usage: ramBudget.py F091-TestGps.map [--limit BYTES]
+
+Every input section placed in the RAM region (.data, .bss, COMMON, the
+heap/stack reserve) is charged to the object file it comes from. Objects of
+the same archive are grouped under the archive name. Space of an output
+section that no object owns (alignment, ._user_heap_stack) is listed as
+"<section> (reserved)".
+
+The build runs it after linking (see makefile.targets). With --limit it exits
+with 1 when the total is above the limit.
+"""
+
+import os
+import re
+import sys
+from collections import defaultdict
+
+HEX = r"0x[0-9a-fA-F]+"
+RE_REGION = re.compile(r"^(\S+)\s+(" + HEX + r")\s+(" + HEX + r")")
+RE_OUTPUT = re.compile(r"^(\.\S+|COMMON)?\s*(" + HEX + r")\s+(" + HEX + r")(?:\s+(\S.*))?$")
+
+
+def module_name(path):
+    path = path.strip()
+    archive = re.match(r"^(.*\.a)\((.*)\)$", path)
+    if archive:
+        return os.path.basename(archive.group(1))
+    return os.path.splitext(os.path.basename(path))[0]
+
+
+def ram_region(lines):
+    in_config = False
+    for line in lines:
+        if line.startswith("Memory Configuration"):
+            in_config = True
+            continue
+        if line.startswith("Linker script and memory map"):
+            break
+        match = RE_REGION.match(line) if in_config else None
+        if match and match.group(1) == "RAM":
+            return int(match.group(2), 16), int(match.group(3), 16)
+    raise SystemExit("no RAM region in the map file")
+
+
+def parse(lines, origin, length):
+    modules = defaultdict(int)
+    reserved = defaultdict(int)
+    section, section_size, section_owned = None, 0, 0
+    pending = None
+
+    def close_section():
+        if section and section_size > section_owned:
+            reserved[section] += section_size - section_owned
+
+    started = False
+    for line in lines:
+        if line.startswith("Linker script and memory map"):
+            started = True
+            continue
+        if not started or not line.strip():
+            continue
+
+        if not line.startswith(" "):   # output section header, LOAD, OUTPUT, ...
+            fields = line.split()
+            close_section()
+            section, section_size, section_owned, pending = None, 0, 0, None
+            if not line.startswith("."):
+                continue
+            if len(fields) >= 3 and re.fullmatch(HEX, fields[1]) and re.fullmatch(HEX, fields[2]):
+                address, size = int(fields[1], 16), int(fields[2], 16)
+                if origin <= address < origin + length and size:
+                    section, section_size = fields[0], size
+            elif len(fields) == 1:
+                pending = fields[0]
+            continue
+
+        if pending is not None:   # header split over two lines
+            fields = line.split()
+            if len(fields) >= 2 and re.fullmatch(HEX, fields[0]) and re.fullmatch(HEX, fields[1]):
+                address, size = int(fields[0], 16), int(fields[1], 16)
+                if origin <= address < origin + length and size:
+                    section, section_size = pending, size
+            pending = None
+            continue
+
+        if section is None:
+            continue
+
+        text = line.strip()
+        if text.startswith("*fill*"):
+            continue
+        match = RE_OUTPUT.match(text)
+        if not match or not match.group(4):
+            continue   # symbol, assignment or input section name alone on its line
+        address, size, owner = int(match.group(2), 16), int(match.group(3), 16), match.group(4)
+        if not (origin <= address < origin + length) or not size:
+            continue
+        if owner.startswith("load address") or "=" in owner:
+            continue
+        modules[module_name(owner)] += size
+        section_owned += size
+    close_section()
+    return modules, reserved
+
+
+def main(argv):
+    if len(argv) < 2:
+        print(__doc__.strip(), file=sys.stderr)
+        return 2
+    limit = None
+    if "--limit" in argv:
+        limit = int(argv[argv.index("--limit") + 1], 0)
+    with open(argv[1]) as handle:
+        lines = handle.read().splitlines()
+
+    origin, length = ram_region(lines)
+    modules, reserved = parse(lines, origin, length)
+    rows = sorted(modules.items(), key=lambda item: -item[1])
+    rows += [(name + " (reserved)", size) for name, size in sorted(reserved.items())]
+    total = sum(size for _, size in rows)
+
+    print("RAM budget: %s (0x%08x, %u bytes)" % (argv[1], origin, length))
+    print("%-32s %8s %6s" % ("module", "bytes", "%RAM"))
+    for name, size in rows:
+        print("%-32s %8u %5.1f%%" % (name, size, 100.0 * size / length))
+    print("%-32s %8u %5.1f%%" % ("total", total, 100.0 * total / length))
+    print("%-32s %8u" % ("free", max(length - total, 0)))
+
+    if limit is not None and total > limit:
+        print("RAM budget exceeded: %u > %u bytes" % (total, limit), file=sys.stderr)
+        return 1
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main(sys.argv))
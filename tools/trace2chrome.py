@@ -0,0 +1,85 @@
+#!/usr/bin/env python3
+"""Convert a 'trace' shell dump into a Chrome trace (chrome://tracing, Perfetto).
+
+Usage: trace2chrome.py console.log > trace.json
+
+The recorder is only built with -DTRACE_ACTIVE=1 (Core/Inc/trace.h).
+
+The dump lines look like (see Core/Src/trace.c):
+    TRACE> T,<task number>,<name>
+    TRACE> E,<time us>,<type>,<id>,<param>
+"""
+
+import json
+import sys
+
+EVT_TASK_IN = 1
+EVT_ISR_ENTER = 2
+EVT_ISR_EXIT = 3
+EVT_QUEUE_ISR = 4
+EVT_NOTIFY_ISR = 5
+EVT_USER = 6
+
+ISR_NAMES = {1: "USART1 (gps)", 2: "USART3 (shell)", 3: "EXTI PPS", 4: "EXTI button"}
+TASKS_PID = 1
+ISR_PID = 2
+
+
+def parse(lines):
+    tasks, events = {}, []
+    for line in lines:
+        if "TRACE> " not in line:
+            continue
+        fields = line.split("TRACE> ", 1)[1].strip().split(",")
+        if fields[0] == "T" and len(fields) == 3:
+            tasks[int(fields[1])] = fields[2]
+        elif fields[0] == "E" and len(fields) == 5:
+            events.append(tuple(int(f) for f in fields[1:]))
+    return tasks, events
+
+
+def convert(tasks, events):
+    out = [{"ph": "M", "name": "process_name", "pid": TASKS_PID, "args": {"name": "tasks"}},
+           {"ph": "M", "name": "process_name", "pid": ISR_PID, "args": {"name": "interrupts"}}]
+    for number, name in tasks.items():
+        out.append({"ph": "M", "name": "thread_name", "pid": TASKS_PID, "tid": number, "args": {"name": name}})
+    for number, name in ISR_NAMES.items():
+        out.append({"ph": "M", "name": "thread_name", "pid": ISR_PID, "tid": number, "args": {"name": name}})
+
+    running = None
+    for time_us, evt, ident, param in events:
+        if evt == EVT_TASK_IN:
+            if running is not None:
+                out.append({"ph": "E", "pid": TASKS_PID, "tid": running, "ts": time_us})
+            running = ident
+            out.append({"ph": "B", "pid": TASKS_PID, "tid": ident, "ts": time_us,
+                        "name": tasks.get(ident, "task %d" % ident)})
+        elif evt in (EVT_ISR_ENTER, EVT_ISR_EXIT):
+            out.append({"ph": "B" if evt == EVT_ISR_ENTER else "E", "pid": ISR_PID, "tid": ident,
+                        "ts": time_us, "name": ISR_NAMES.get(ident, "isr %d" % ident)})
+        elif evt == EVT_QUEUE_ISR:
+            out.append({"ph": "i", "s": "t", "pid": ISR_PID, "tid": 0, "ts": time_us,
+                        "name": "queue send 0x%04x" % param})
+        elif evt == EVT_NOTIFY_ISR:
+            out.append({"ph": "i", "s": "t", "pid": TASKS_PID, "tid": ident, "ts": time_us,
+                        "name": "notify from isr"})
+        else:
+            out.append({"ph": "i", "s": "g", "pid": TASKS_PID, "tid": 0, "ts": time_us,
+                        "name": "user %d/%d" % (ident, param)})
+    if running is not None and events:
+        out.append({"ph": "E", "pid": TASKS_PID, "tid": running, "ts": events[-1][0]})
+    return {"traceEvents": out, "displayTimeUnit": "ms"}
+
+
+def main():
+    if len(sys.argv) != 2:
+        sys.stderr.write(__doc__)
+        return 1
+    with open(sys.argv[1], errors="replace") as log:
+        tasks, events = parse(log)
+    json.dump(convert(tasks, events), sys.stdout, indent=1)
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())